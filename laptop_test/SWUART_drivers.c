@@ -1,9 +1,67 @@
 #include "SWUART_drivers.h"
+#include "SWUART_engine.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
-#define GPIONUM 2 //number of gpio pins
-char gpio[GPIONUM];//emulated gpio
+#ifndef GPIONUM
+#define GPIONUM 4 //number of gpio pins (2 and 3 used by the second engine of main.c)
+#endif
+#define PORTBITS 32 //number of pins on each emulated port
+#define PORTNUM ((GPIONUM+PORTBITS-1)/PORTBITS) //number of emulated ports
+portword gpio[PORTNUM];//emulated gpio (bit n of gpio[p] is pin p*PORTBITS+n)
+portword edgeArmed[PORTNUM];//emulated edge interrupts (bit set if pin armed)
+int edgeId[GPIONUM];//id to be passed to SWUART_edge() by each armed pin
+
+//lock-step mode of the sharded simulation (see rack.c), set by each thread with simLockStep():
+//the pins are read from simIn and written to simOut (without edge interrupts), NULL in normal mode
+_Thread_local portword *simIn=NULL;
+_Thread_local portword *simOut=NULL;
+
+void simLockStep(portword *in,portword *out){
+    simIn=in;
+    simOut=out;
+}
+
+//output timing of the ISR benchmark (see bench.c): readCycles() of the first and last output write
+//since the last simOutputTimes() call, recorded only after simTimeOutputs(1)
+char outTiming=0;
+unsigned long outFirst=0, outLast=0;
+
+void simTimeOutputs(char on){
+    outTiming=on;
+    outFirst=0;
+    outLast=0;
+}
+
+void simOutputTimes(unsigned long *first,unsigned long *last){
+    *first=outFirst;
+    *last=outLast;
+    outFirst=0;
+    outLast=0;
+}
+
+//function to record the time of an output write
+static void timeOutput(){
+    if(outTiming){
+        outLast=readCycles();
+        if(outFirst==0) outFirst=outLast;
+    }
+}
+
+//function to set the value of an emulated port, calling SWUART_edge() for the armed pins that fell
+//(the emulated edge interrupt fires as soon as the pin is written)
+static void setPort(int port,portword val){
+    portword fell=gpio[port] & ~val & edgeArmed[port]; //armed pins with falling edge
+    gpio[port]=val;
+    for(int b=0;fell;b++){
+        if((fell>>b) & 1){
+            fell&=~(((portword)1)<<b);
+            edgeArmed[port]&=~(((portword)1)<<b); //one-shot, disarming
+            SWUART_edge(edgeId[port*PORTBITS+b]);
+        }
+    }
+}
 
 int getGPIONUM(){
     return GPIONUM;
@@ -17,17 +75,25 @@ void startTimer(){}
 
 void setPinMode(int pin,char mode){
     if(pin<GPIONUM)
-        gpio[pin]=1;
+        setPort(pin/PORTBITS,gpio[pin/PORTBITS] | ((portword)1)<<(pin%PORTBITS));
 }
 
 void writePin(int pin,char val){
-    if(pin<GPIONUM)
-        gpio[pin]=val;
+    timeOutput();
+    if(pin<GPIONUM && simOut){
+        if(val) simOut[pin/PORTBITS]|=((portword)1)<<(pin%PORTBITS);
+        else simOut[pin/PORTBITS]&=~(((portword)1)<<(pin%PORTBITS));
+    }else if(pin<GPIONUM){
+        if(val)
+            setPort(pin/PORTBITS,gpio[pin/PORTBITS] | ((portword)1)<<(pin%PORTBITS));
+        else
+            setPort(pin/PORTBITS,gpio[pin/PORTBITS] & ~(((portword)1)<<(pin%PORTBITS)));
+    }
 }
 
 char readPin(int pin){
     if(pin<GPIONUM)
-        return gpio[pin];
+        return ((simIn?simIn:gpio)[pin/PORTBITS]>>(pin%PORTBITS)) & 1;
 
     return 'U';
 }
@@ -35,3 +101,118 @@ char readPin(int pin){
 void disableInt(){}
 
 void enableInt(){}
+
+char getPinPort(int pin,unsigned char *port,unsigned char *bit){
+    if(pin>=GPIONUM)
+        return 1;
+
+    *port=pin/PORTBITS;
+    *bit=pin%PORTBITS;
+    return 0;
+}
+
+portword readPort(unsigned char port){
+    return simIn?simIn[port]:gpio[port];
+}
+
+void writePort(unsigned char port,portword mask,portword val){
+    timeOutput();
+    if(simOut) simOut[port]=(simOut[port] & ~mask) | (val & mask);
+    else setPort(port,(gpio[port] & ~mask) | (val & mask));
+}
+
+char armEdge(int pin,int id){
+    if(pin>=GPIONUM)
+        return 1;
+
+    edgeId[pin]=id;
+    edgeArmed[pin/PORTBITS]|=((portword)1)<<(pin%PORTBITS);
+    return 0;
+}
+
+//emulated DMA of the TX waveform ring (only after simUseWaveDMA(1), otherwise startWaveDMA() reports
+//it as not available), simWaveDMA() is its timer event and writes the next ring slot
+char waveDMAon=0;
+unsigned char dmaPort;
+portword dmaMask=0;
+volatile portword *dmaRing=NULL;
+int dmaSlots, dmaPos;
+
+void simUseWaveDMA(char on){
+    waveDMAon=on;
+}
+
+void simWaveDMA(){
+    if(dmaMask==0) return; //if not running
+    writePort(dmaPort,dmaMask,dmaRing[dmaPos]);
+    dmaPos=(dmaPos+1)%dmaSlots;
+}
+
+char startWaveDMA(unsigned char port,portword mask,volatile portword *ring,int slots){
+    if(!waveDMAon) return 1;
+    if(dmaMask==0) dmaPos=0; //if starting, from slot 0
+    dmaPort=port;
+    dmaMask=mask;
+    dmaRing=ring;
+    dmaSlots=slots;
+    return 0;
+}
+
+//emulated tick functions (only after simTickless(1), otherwise setNextTick() keeps the fixed rate so the
+//programs calling SWUART_isr() directly still work), simTimer() is the timer event of one quantum and
+//calls SWUART_isr() when it is due, it returns 1 if it called it
+char ticklessOn=0;
+unsigned char tickLeft=1, tickDelta=1;
+
+char simTimer(){
+    simWaveDMA(); //timer event (before the ISR)
+    if(--tickLeft!=0) return 0;
+    tickLeft=1;
+    tickDelta=1;
+    SWUART_isr();
+    return 1;
+}
+
+void simTickless(char on){
+    ticklessOn=on;
+    if(!on) while(!simTimer()); //the call already programmed (then one call per quantum)
+}
+
+unsigned char setNextTick(unsigned char delta){
+    if(!ticklessOn) delta=1;
+    tickLeft=delta;
+    tickDelta=delta;
+    return delta;
+}
+
+unsigned char wakeTick(){
+    unsigned char step=tickDelta-tickLeft+1;
+    tickDelta=step;
+    tickLeft=1;
+    return step;
+}
+
+//engine with its own emulated timer (NULL if none), stepped by waitTick() at every quantum together with the
+//default engine, so the blocking functions of that engine also see the time passing while they wait
+SWUARTengine *simEngine=NULL;
+
+void simEngineTimer(SWUARTengine *eng){
+    simEngine=eng;
+}
+
+void waitTick(){
+    char called=0;
+    while(!called){ //the emulated timers tick while the program waits, until an ISR is called
+        called=simTimer();
+        if(simEngine){
+            SWUARTengine_isr(simEngine);
+            called=1;
+        }
+    }
+}
+
+unsigned long readCycles(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (unsigned long)ts.tv_sec*1000000000UL+(unsigned long)ts.tv_nsec; //nanoseconds
+}
@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "SWUART.h"
+#include "SWUART_engine.h"
+#include "SWUART_drivers.h"
+
+/* ISR BENCHMARK
+ *
+ * Drives the SWUART ISR (SWUARTengine_isr(), the same hot path of SWUART_isr()) on an engine of
+ * 1 to BENCHMAXUARTS UARTs wired in a ring on the emulated GPIO bank (UART u transmits on pin u and
+ * receives from pin u+1, the last one from pin 0), with three traffic loads:
+ * idle - no UART transmits, every line is only sampled for START bits
+ * half - the even UARTs keep their TX buffer full, so half of the lines carry back to back frames
+ * full - all the UARTs keep their TX buffer full (saturated TX and RX)
+ *
+ * Only the ISR calls are timed, the TX buffers are refilled and the RX buffers are emptied
+ * between batches of BATCH quanti. After the timed quanti, BATCH more quanti measure when the TX pins
+ * are written (readCycles() of the laptop driver at each pin/port write) from the beginning of each call.
+ * The results are printed as CSV (lines starting with # are comments):
+ * uarts,load,ticks,ns_per_isr,ns_per_uart_tick,rx_bytes,bytes_per_sec,out_min_ns,out_max_ns
+ * where bytes_per_sec is the number of received bytes per second of ISR time and out_min_ns/out_max_ns
+ * are the earliest and latest output write from the ISR entry (their difference is the output edge jitter,
+ * -1 if no pin was written), compare STAGEDTX set and not set.
+ *
+ * usage: bench [ticks per run (default 100000)] [maximum number of UARTs (default BENCHMAXUARTS)]
+ */
+
+#define BENCHMAXUARTS 1024 //largest engine of the sweep (needs MAXUARTS>=255, MAXPIN>=BENCHMAXUARTS-1 and GPIONUM>=BENCHMAXUARTS)
+#define BATCH 256 //quanti timed between two refills (less than the duration of a full TX buffer)
+#define BENCHRXLEN 16 //RX buffer length of the benchmark engines
+#define BENCHTXLEN 16 //TX buffer length of the benchmark engines
+
+#if MAXSLOTS<BENCHMAXUARTS || MAXPIN<BENCHMAXUARTS-1
+#error "the benchmark needs MAXUARTS>=255 and MAXPIN>=1023 in SWUART.h"
+#endif
+
+int getGPIONUM(); //number of emulated pins of the laptop test driver
+void simTimeOutputs(char on); //output write timing of the laptop test driver
+void simOutputTimes(unsigned long *first,unsigned long *last);
+
+const char *loadNames[3]={"idle","half","full"};
+
+//function to read a monotonic nanoseconds timestamp
+static unsigned long long nowNs(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (unsigned long long)ts.tv_sec*1000000000ULL+(unsigned long long)ts.tv_nsec;
+}
+
+//function to check if UART u transmits with the given load
+static int sending(int u,int load){
+    return load==2 || (load==1 && (u%2)==0);
+}
+
+//function to refill the TX buffers and empty the RX buffers of the n UARTs of eng, returns the received bytes
+static long service(SWUARTengine *eng,int n,int load){
+    static char data[BENCHTXLEN];
+    static char rx[BENCHRXLEN];
+    long bytes=0;
+    for(int u=0;u<n;u++){
+        if(sending(u,load)){
+            for(int c=0;c<BENCHTXLEN;c++) data[c]=(char)(u+c); //payload depending on UART and position
+            SWUARTengineSendBufferH(eng,data,BENCHTXLEN,u); //only the free slots are filled
+        }
+        int r;
+        while((r=SWUARTengineReceiveBufferH(eng,rx,BENCHRXLEN,u,NULL))>0) bytes+=r;
+    }
+    return bytes;
+}
+
+//function to benchmark an engine of n UARTs for ticks quanti with the given load, prints the CSV line
+static int benchRun(int n,int load,long ticks){
+    SWUARTengine eng;
+    int retVal=1;
+    int W=SLICEWORDS(n);
+    UARTDS *UARTs=(UARTDS*)malloc(n*sizeof(UARTDS));
+    UARTtx *TXstate=(UARTtx*)malloc(n*sizeof(UARTtx));
+    RXline *lines=(RXline*)malloc(n*sizeof(RXline));
+    message *RXstore=(message*)malloc(n*(BENCHRXLEN+1)*sizeof(message));
+    txmessage *TXstore=(txmessage*)malloc(n*(BENCHTXLEN+1)*sizeof(txmessage));
+    sliceword *masks=(sliceword*)malloc(SLICEMASKS(BITQUANTI)*W*sizeof(sliceword));
+    sliceword *sync=(sliceword*)malloc(SYNCMASKS*W*sizeof(sliceword));
+    if(!UARTs || !TXstate || !lines || !RXstore || !TXstore || !masks || !sync){
+        printf("# out of memory for %d UARTs\n",n);
+        goto cleanup;
+    }
+
+    SWUARTengineInit(&eng,n,BENCHRXLEN,BENCHTXLEN,BITQUANTI,SMPQUANTUM,UARTs,TXstate,lines,RXstore,TXstore,masks,sync);
+    for(int u=0;u<n;u++){
+        int ret=SWUARTengineAddUnnamedH(&eng,u,(u+1)%n); //UARTs without name (more than 255)
+        if(ret!=u){
+            printf("# error %d adding UART %d\n",-ret,u);
+            goto cleanup;
+        }
+    }
+
+    //warm up (blank messages of SWUARTengineAddUnnamedH() and first frames), not timed
+    for(int b=0;b<4;b++){
+        service(&eng,n,load);
+        for(int s=0;s<BATCH;s++) SWUARTengine_isr(&eng);
+    }
+    service(&eng,n,load);
+
+    unsigned long long ns=0;
+    long bytes=0;
+    long done=0;
+    while(done<ticks){
+        long batch=(ticks-done<BATCH)?ticks-done:BATCH;
+        unsigned long long t0=nowNs();
+        for(long s=0;s<batch;s++) SWUARTengine_isr(&eng);
+        ns+=nowNs()-t0;
+        done+=batch;
+        bytes+=service(&eng,n,load);
+    }
+    if(ns==0) ns=1;
+
+    //output timing (not timed)
+    long outMin=-1, outMax=-1;
+    simTimeOutputs(1);
+    for(int s=0;s<BATCH;s++){
+        unsigned long first, last;
+        unsigned long t0=readCycles();
+        SWUARTengine_isr(&eng);
+        simOutputTimes(&first,&last);
+        if(first==0) continue; //no pin written
+        if(outMin<0 || (long)(first-t0)<outMin) outMin=(long)(first-t0);
+        if((long)(last-t0)>outMax) outMax=(long)(last-t0);
+    }
+    simTimeOutputs(0);
+    service(&eng,n,load);
+
+    printf("%d,%s,%ld,%.2f,%.3f,%ld,%.0f,%ld,%ld\n",n,loadNames[load],ticks,(double)ns/ticks,
+            (double)ns/ticks/n,bytes,bytes*1e9/ns,outMin,outMax);
+    fflush(stdout);
+    retVal=0;
+
+cleanup: //(free(NULL) does nothing)
+    free(UARTs); free(TXstate); free(lines); free(RXstore); free(TXstore); free(masks); free(sync);
+    return retVal;
+}
+
+int main(int argc,char **argv)
+{
+    long ticks=(argc>1)?atol(argv[1]):100000;
+    int maxUARTs=(argc>2)?atoi(argv[2]):BENCHMAXUARTS;
+    if(ticks<=0 || maxUARTs<1 || maxUARTs>BENCHMAXUARTS || maxUARTs>getGPIONUM()){
+        printf("usage: bench [ticks] [UARTs (1:%d, GPIONUM %d)]\n",BENCHMAXUARTS,getGPIONUM());
+        return 1;
+    }
+
+    printf("# SWUART ISR benchmark: BITQUANTI %d SMPQUANTUM %d BITSLICED %d PORTIO %d MAXPORTS %d STAGEDTX %d EDGERX 0\n",
+            BITQUANTI,SMPQUANTUM,BITSLICED,PORTIO,MAXPORTS,STAGEDTX);
+    printf("uarts,load,ticks,ns_per_isr,ns_per_uart_tick,rx_bytes,bytes_per_sec,out_min_ns,out_max_ns\n");
+    for(int n=1;n<=maxUARTs;n*=2){
+        for(int load=0;load<3;load++){
+            if(benchRun(n,load,ticks)) return 1;
+        }
+    }
+
+    return 0;
+}
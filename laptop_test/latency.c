@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SWUART.h"
+#include "SWUART_drivers.h"
+
+/* LATENCY BENCHMARK
+ *
+ * UART A (TX pin 0, RX pin 1) sends to UART B (TX pin 1, RX pin 0) on the emulated GPIO bank, the messages
+ * are enqueued at random quanti (each quantum with probability load/FRAMEQUANTI, so load is the offered
+ * share of the line) and B is read after every SWUART_isr() call. Each message is followed with the
+ * stamps of TIMESTAMPS and the quantum counter (all in quanti):
+ * queue - time spent inside the TX buffer of A (START quantum - enqueue quantum)
+ * wire - time from the START bit sent by A to the message read from B (frame time and RX detection)
+ * e2e - end-to-end latency (quantum of the read from B - enqueue quantum, so queue+wire)
+ * link - START quantum detected by B - START quantum of A (constant, the two boards are correlated by it)
+ * The distributions are printed as CSV (lines starting with # are comments):
+ * load,metric,count,min,p50,p90,p99,max,mean
+ *
+ * usage: latency [messages per load (default 20000)]
+ */
+
+#define FRAMEQUANTI (11*BITQUANTI) //quanti of a 8E1 frame (the default format)
+#define METRICS 4 //number of measured metrics
+
+#if !TIMESTAMPS
+#error "the latency benchmark needs TIMESTAMPS set in SWUART.h"
+#endif
+
+const char *metricNames[METRICS]={"queue","wire","e2e","link"};
+const double loads[]={0.1,0.5,0.8,0.95,1.2}; //offered loads (above 1 the TX buffer fills and messages are refused)
+
+//function to compare two longs for qsort()
+static int cmpLong(const void *a,const void *b){
+    long x=*(const long*)a, y=*(const long*)b;
+    return (x>y)-(x<y);
+}
+
+//function to print the distribution of the n values v (sorted in place) as a CSV line
+static void printDist(double load,const char *name,long *v,long n){
+    double sum=0;
+    qsort(v,n,sizeof(long),cmpLong);
+    for(long i=0;i<n;i++) sum+=v[i];
+    printf("%.2f,%s,%ld,%ld,%ld,%ld,%ld,%ld,%.1f\n",load,name,n,v[0],v[n/2],v[n*9/10],v[n*99/100],v[n-1],sum/n);
+}
+
+//function to send num messages from A to B with the given load and print the latencies, returns 1 if stamps are inconsistent
+static int latencyRun(double load,long num,long *enq,long *start,long *rxStamp,long *deq){
+    long sent=0, started=0, received=0, refused=0, errors=0;
+    swtick enqueued, lastStart, stamp;
+    char c;
+    SWUARTgetTXStamps(&enqueued,&lastStart,'A');
+
+    while(received<num){
+        if(sent<num && rand()<load*RAND_MAX/FRAMEQUANTI){ //message arrival
+            if(SWUARTsend((char)sent,'A',0,0)==0) enq[sent++]=(long)SWUARTgetTicks();
+            else refused++; //TX buffer full
+        }
+
+        SWUART_isr();
+
+        swtick st;
+        SWUARTgetTXStamps(&enqueued,&st,'A');
+        if(st!=lastStart){ //new frame started
+            if(started>=sent || (long)enqueued!=enq[started]) errors++;
+            else start[started++]=(long)st;
+            lastStart=st;
+        }
+        while(SWUARTreceiveStamped(&c,&stamp,'B')==0){
+            if(received>=started || c!=(char)received) errors++;
+            else{
+                rxStamp[received]=(long)stamp;
+                deq[received++]=(long)SWUARTgetTicks();
+            }
+        }
+        if(errors) break;
+    }
+    if(errors){
+        printf("# load %.2f: stamps not matching the messages\n",load);
+        return 1;
+    }
+
+    printf("# load %.2f: %ld messages, %ld refused with the TX buffer full\n",load,num,refused);
+    long *v=(long*)malloc(num*sizeof(long));
+    for(int m=0;m<METRICS;m++){
+        for(long i=0;i<num;i++){
+            if(m==0) v[i]=start[i]-enq[i];
+            if(m==1) v[i]=deq[i]-start[i];
+            if(m==2) v[i]=deq[i]-enq[i];
+            if(m==3) v[i]=rxStamp[i]-start[i];
+        }
+        printDist(load,metricNames[m],v,num);
+    }
+    free(v);
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc,char **argv)
+{
+    long num=(argc>1)?atol(argv[1]):20000;
+    if(num<=0){
+        printf("usage: latency [messages per load]\n");
+        return 1;
+    }
+    int retVal=1;
+    long *enq=(long*)malloc(num*sizeof(long));
+    long *start=(long*)malloc(num*sizeof(long));
+    long *rxStamp=(long*)malloc(num*sizeof(long));
+    long *deq=(long*)malloc(num*sizeof(long));
+    if(!enq || !start || !rxStamp || !deq){
+        printf("# out of memory\n");
+        goto cleanup;
+    }
+
+    SWUARTinit();
+    if(SWUARTadd(0,1,'A') || SWUARTadd(1,0,'B')){
+        printf("# error adding the UARTs\n");
+        goto cleanup;
+    }
+    for(int s=0;s<2*FRAMEQUANTI;s++) SWUART_isr(); //blank messages of SWUARTadd()
+
+    srand(1); //same traffic on every run
+    printf("# SWUART latency benchmark (quanti): BITQUANTI %d SMPQUANTUM %d TXBUFFLEN %d BITSLICED %d\n",
+            BITQUANTI,SMPQUANTUM,TXBUFFLEN,BITSLICED);
+    printf("load,metric,count,min,p50,p90,p99,max,mean\n");
+    for(unsigned l=0;l<sizeof(loads)/sizeof(loads[0]);l++){
+        if(latencyRun(loads[l],num,enq,start,rxStamp,deq)) goto cleanup;
+        for(int s=0;s<2*FRAMEQUANTI;s++) SWUART_isr(); //line idle between the runs
+    }
+
+    retVal=0;
+
+cleanup: //(free(NULL) does nothing)
+    free(enq); free(start); free(rxStamp); free(deq);
+    return retVal;
+}
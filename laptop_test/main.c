@@ -4,7 +4,9 @@
 #include "myList.h"
 #include "SWUART.h"
 #include "SWUART_drivers.h"
+#include "SWUART_engine.h"
 #include <string.h>
+#include <time.h>
 
 int printIndex=0; //time index to be printed with output
 char guiText[400];
@@ -42,6 +44,10 @@ void translateErr(int code, char*str){ //function to translate the error codes o
  * EMPTYBUFF 5 //buffer is empty
  * PARERR 6 //parity bit wrong
  * STOPERR 7 //stop violation
+ * BAUDERR 8 //bit length not supported
+ * FORMATERR 9 //frame format not supported
+ * PINERR 10 //pin number out of 0:MAXPIN
+ * TIMEOUT 11 //timeout expired
  */
  str[0]='\0';
  switch(code){
@@ -53,6 +59,10 @@ void translateErr(int code, char*str){ //function to translate the error codes o
     case 5: strcat(str,"EMPTYBUFF"); break;
     case 6: strcat(str,"PARERR"); break;
     case 7: strcat(str,"STOPERR"); break;
+    case 8: strcat(str,"BAUDERR"); break;
+    case 9: strcat(str,"FORMATERR"); break;
+    case 10: strcat(str,"PINERR"); break;
+    case 11: strcat(str,"TIMEOUT"); break;
 }
 }
 
@@ -125,6 +135,202 @@ sendWrongStop(int pin){ //sends a message with wrong stop bit
 
 }
 
+int testFormats(){ //sends some words from A to B with each frame format and checks them, returns the number of failed formats
+    int errors=0;
+    unsigned short msg;
+    printf("\nFRAME FORMATS CHECK\n");
+    for(int s=0;s<14*BITQUANTI;s++) SWUART_isr(); //letting the frames of the previous steps end
+    for(int bits=5;bits<=9;bits++){
+        for(int par=PARNONE;par<=PARODD;par++){
+            for(int stop=1;stop<=2;stop++){
+                char format=FORMAT(bits,par,stop);
+                SWUARTsetFormat(format,'A');
+                SWUARTsetFormat(format,'B');
+                SWUARTclearBuffer(1,'B');
+                for(int m=0;m<4;m++) SWUARTsendWord(m*0x9D+bits,'A',0,0);
+                for(int s=0;s<4*14*BITQUANTI+BITQUANTI;s++) SWUART_isr(); //enough quanti for 4 frames of the longest format
+
+                int ok=0;
+                for(int m=0;m<4;m++){
+                    if(SWUARTreceiveWord(&msg,'B')==0 && msg==((m*0x9D+bits) & ((1<<bits)-1))) ok++;
+                }
+                if(ok!=4) errors++;
+                printf("%d%c%d: %d/4 %s\n",bits,"NEO"[par],stop,ok,(ok==4)?"OK":"FAIL");
+            }
+        }
+    }
+    return errors;
+}
+
+#define BEATS 100 //heartbeats of the virtual time check
+#define BEATPERIOD 100000 //quanti between two heartbeats (e.g. 1s with a 100kHz timer)
+#define WAKE 101 //heartbeat code (as in demo.ino)
+
+long simTime; //current quantum of the simulation
+long simCalls; //SWUART_isr() calls of the simulation
+unsigned long simHash; //hash of the pin changes and of the received messages of the simulation
+
+void simRun(long end,char fast){ //simulates until quantum end calling SWUART_isr(), if fast is set jumping over the idle quanti
+    while(simTime<end){
+        if(fast){
+            unsigned long skipped=SWUARTskip(end-simTime); //no events before end
+            if(skipped){
+                simTime+=skipped;
+                continue;
+            }
+        }
+        char old=readPin(0)*2+readPin(1);
+        SWUART_isr();
+        simCalls++;
+        simTime++;
+        char val=readPin(0)*2+readPin(1);
+        if(val!=old) simHash=simHash*31+simTime*4+val; //logging pin change
+    }
+}
+
+int simReceive(char UARTname){ //reads all the messages of UART UARTname into the simulation hash, returns how many
+    char msg;
+    int num=0;
+    while(SWUARTreceive(&msg,UARTname)==0){
+        simHash=simHash*31+simTime*256+(unsigned char)msg;
+        num++;
+    }
+    return num;
+}
+
+unsigned long testHeartbeat(char fast){ //A and B send a heartbeat each BEATPERIOD quanti, returns the simulation hash
+    int received=0;
+    simTime=0;
+    simCalls=0;
+    simHash=0;
+    SWUARTclearBuffer(1,'A');
+    SWUARTclearBuffer(1,'B');
+    for(int beat=0;beat<=BEATS;beat++){
+        simRun((long)beat*BEATPERIOD,fast);
+        received+=simReceive('A');
+        received+=simReceive('B');
+        if(beat<BEATS){
+            SWUARTsend(WAKE,'A',0,0);
+            SWUARTsend(WAKE,'B',0,0);
+        }
+    }
+    if(received!=2*BEATS) simHash=0; //heartbeats lost
+    return simHash;
+}
+
+#if UARTEVENTS
+int evCount[3]; //callbacks called for EVRX, EVTXDONE and EVERROR
+char evLastCode; //error code of the last EVERROR
+
+void countEvent(int handle, char event, char code){ //event callback, counting the events
+    (void)handle;
+    if(event==EVRX) evCount[0]++;
+    if(event==EVTXDONE) evCount[1]++;
+    if(event==EVERROR){
+        evCount[2]++;
+        evLastCode=code;
+    }
+}
+#endif
+
+#if UARTSTATS
+//function to write on pin a 8E1 frame of 0x0F (4 ones, even parity bit 0) with the given parity and stop levels
+void statsFrame(int pin,char par,char stop){
+    char level[11]={0,1,1,1,1,0,0,0,0,par,stop}; //START, data (LSB first), parity, STOP
+    for(int b=0;b<11;b++){
+        writePin(pin,level[b]);
+        for(int s=0;s<BITQUANTI;s++) SWUART_isr();
+    }
+    writePin(pin,1);
+    for(int s=0;s<2*11*BITQUANTI;s++) SWUART_isr(); //line idle
+}
+#endif
+
+#if WAITTICK
+void simEngineTimer(SWUARTengine *eng); //emulated timer of a second engine of the laptop test driver
+
+//second engine (C and D on pins 2 and 3), for the blocking functions of the engines
+#define EXTUARTS 2
+SWUARTengine extEng;
+UARTDS extUARTs[EXTUARTS];
+UARTtx extTXstate[EXTUARTS];
+RXline extLines[EXTUARTS];
+message extRXstore[EXTUARTS*(RXBUFFLEN+1)];
+txmessage extTXstore[EXTUARTS*(TXBUFFLEN+1)];
+sliceword extMasks[SLICEMASKS(BITQUANTI)*SLICEWORDS(EXTUARTS)];
+volatile sliceword extSync[SYNCMASKS*SLICEWORDS(EXTUARTS)];
+#endif
+
+#if TXWAVE
+void simUseWaveDMA(char on); //emulated DMA of the laptop test driver
+void simWaveDMA();
+
+#define WAVETRACE (4*14*BITQUANTI+BITQUANTI) //quanti of TX pin recorded by waveRun() (4 frames of the longest format)
+
+//function to send 4 messages from A with its TX sequenced by the ISR (mode 0), rendered and output by the ISR (mode 1)
+//or rendered and output by the emulated DMA (mode 2), recording its TX pin from the first START into trace,
+//returns 1 if B received the messages
+int waveRun(int mode,char *trace){
+    char rx[4];
+    int got=0, n=0;
+    for(int s=0;s<14*BITQUANTI;s++) SWUART_isr(); //letting the frames of the previous steps end
+    SWUARTclearBuffer(1,'B');
+    simUseWaveDMA(mode==2);
+    if(mode) SWUARTsetWave(1,'A');
+    SWUARTsendBuffer("wave",4,'A');
+    for(int s=0;n<WAVETRACE && s<WAVETRACE+WAVELEN+20;s++){
+        SWUARTrender(); //main loop
+        simWaveDMA(); //timer event
+        SWUART_isr();
+        if(n>0 || readPin(0)==0) trace[n++]=readPin(0);
+    }
+    for(int s=0;s<14*BITQUANTI;s++){ //letting the last frame end
+        SWUARTrender();
+        simWaveDMA();
+        SWUART_isr();
+    }
+    while(got<4 && SWUARTreceive(&rx[got],'B')==0) got++;
+    if(mode) SWUARTsetWave(0,'A');
+    return n==WAVETRACE && got==4 && memcmp(rx,"wave",4)==0;
+}
+#endif
+
+#if TICKLESS
+void simTickless(char on); //emulated tick functions of the laptop test driver
+char simTimer();
+
+#define TICKLESSRUN (40*14*BITQUANTI) //quanti simulated by ticklessRun()
+
+int pinLevels(){ //returns the levels of all the emulated pins (bit p is pin p)
+    int val=0;
+    for(int p=0;p<getGPIONUM();p++) val|=readPin(p)<<p;
+    return val;
+}
+
+//function to send 3 bursts of messages from each UART of senders (with idle gaps) stepping the emulated timer with the
+//tick functions off (fixed rate) or on, returns the hash of the pin changes and of the messages received by receiver
+//(0 if none) and writes into calls the SWUART_isr() calls
+unsigned long ticklessRun(char on,long *calls,const char *senders,char receiver){
+    unsigned long hash=0;
+    char msg;
+    for(int s=0;s<14*BITQUANTI;s++) SWUART_isr(); //letting the frames of the previous steps end
+    if(receiver) SWUARTclearBuffer(1,receiver);
+    simTickless(on);
+    *calls=0;
+    int old=pinLevels();
+    for(long q=0;q<TICKLESSRUN;q++){
+        if(q%(TICKLESSRUN/3)==7) for(const char *u=senders;*u;u++) SWUARTsendBuffer("tick",4,*u); //burst
+        *calls+=simTimer();
+        int val=pinLevels();
+        if(val!=old) hash=hash*31+q*16+val; //logging pin change
+        old=val;
+        while(receiver && SWUARTreceive(&msg,receiver)==0) hash=hash*31+q*256+(unsigned char)msg;
+    }
+    simTickless(0);
+    return hash;
+}
+#endif
+
 int main()
 {
     //PRINTING TITLE
@@ -137,9 +343,25 @@ int main()
     //simulation variables reset
     guiText[0]='\0';
     //useful variables
-    char msg;
+    char msg=0; //(printed also when a receive fails)
 
     SWUARTinit();
+
+#if TICKLESS
+    //TX ONLY TICKLESS CHECK (T and U have no RX line, so the ISR calls skip to their next bit change, done before
+    //adding A and B since their RX lines keep one call per quantum)
+    printf("TX ONLY TICKLESS CHECK\n");
+    long txFixedCalls, txTicklessCalls;
+    int txOK=SWUARTadd(2,NORXPIN,'T')==0 && SWUARTadd(3,NORXPIN,'U')==0;
+    unsigned long txFixedHash=ticklessRun(0,&txFixedCalls,"TU",0);
+    unsigned long txTicklessHash=ticklessRun(1,&txTicklessCalls,"TU",0);
+    printf("fixed rate: %ld ISR calls, tickless: %ld ISR calls in %ld quanti\n",txFixedCalls,txTicklessCalls,
+            (long)TICKLESSRUN);
+    txOK=txOK && txFixedHash!=0 && txFixedHash==txTicklessHash && txTicklessCalls<txFixedCalls;
+    printf("%s\n",txOK?"same waveforms, OK":"FAIL");
+    if(!txOK) return 1;
+#endif
+
     addGui1("Add UART", SWUARTadd(0,1,'A'));
     addGui1("Add UART", SWUARTadd(1,0,'B'));
     addGui1("Send", SWUARTsend(23,'B',1,0));
@@ -156,6 +378,213 @@ int main()
     addGui2("B reads ",msg,SWUARTreceive(&msg,'B'));
     step(1);
 
+    //FRAME FORMATS CHECK
+    if(testFormats()) return 1;
+
+    //VIRTUAL TIME CHECK (heartbeats simulated both stepping every quantum and fast-forwarding the idle quanti)
+    printf("\nVIRTUAL TIME CHECK\n");
+    clock_t c0=clock();
+    unsigned long stepHash=testHeartbeat(0);
+    long stepCalls=simCalls;
+    clock_t c1=clock();
+    unsigned long fastHash=testHeartbeat(1);
+    long fastCalls=simCalls;
+    clock_t c2=clock();
+    printf("stepped: %ld quanti, %ld isr calls, %ldms\n",simTime,stepCalls,(long)((c1-c0)*1000/CLOCKS_PER_SEC));
+    printf("fast-forward: %ld quanti, %ld isr calls, %ldms\n",simTime,fastCalls,(long)((c2-c1)*1000/CLOCKS_PER_SEC));
+    printf("%s\n",(stepHash!=0 && stepHash==fastHash)?"OK":"FAIL");
+    if(stepHash==0 || stepHash!=fastHash) return 1;
+
+#if WAITTICK
+    //BLOCKING FUNCTIONS CHECK (waitTick() of the laptop driver calls SWUART_isr(), so the time passes while waiting)
+    printf("\nBLOCKING CHECK\n");
+    char rx;
+    int sent=0, got=0, ret;
+    SWUARTclearBuffer(1,'B');
+    for(int m=0;m<3*TXBUFFLEN;m++){ //more messages than the TX buffer, waiting for free slots
+        if(SWUARTsendTimeout(m,'A',0,0,FOREVER)==0) sent++;
+        while(SWUARTreceive(&rx,'B')==0) if(rx==got) got++;
+    }
+    while((ret=SWUARTreceiveTimeout(&rx,'B',14*BITQUANTI))==0) if(rx==got) got++; //waiting up to a frame for each message
+    translateErr(ret,guiText);
+    printf("sent %d, received %d in order, last receive %s\n",sent,got,guiText);
+    guiText[0]='\0';
+    if(sent!=3*TXBUFFLEN || got!=sent || ret!=TIMEOUT) return 1;
+
+    //same on a second engine (its emulated timer also ticks while waiting)
+    SWUARTengineInit(&extEng,EXTUARTS,RXBUFFLEN,TXBUFFLEN,BITQUANTI,SMPQUANTUM,extUARTs,extTXstate,extLines,
+            extRXstore,extTXstore,extMasks,extSync);
+    int C=SWUARTengineAddH(&extEng,2,3,'C');
+    int D=SWUARTengineAddH(&extEng,3,2,'D');
+    unsigned short wrx;
+    simEngineTimer(&extEng);
+    sent=0;
+    got=0;
+    for(int m=0;m<3*TXBUFFLEN;m++){
+        if(SWUARTengineSendWordTimeoutH(&extEng,m,C,0,0,FOREVER)==0) sent++;
+        while(SWUARTengineReceiveWordH(&extEng,&wrx,D)==0) if(wrx==got) got++;
+    }
+    while((ret=SWUARTengineReceiveWordTimeoutH(&extEng,&wrx,D,14*BITQUANTI))==0) if(wrx==got) got++;
+    simEngineTimer(NULL);
+    translateErr(ret,guiText);
+    printf("second engine: sent %d, received %d in order, last receive %s\n",sent,got,guiText);
+    guiText[0]='\0';
+    if(C<0 || D<0 || sent!=3*TXBUFFLEN || got!=sent || ret!=TIMEOUT) return 1;
+#endif
+
+#if PACKETRX
+    //PACKET MODE CHECK (B delimits the packets first by newline, then by an idle gap of 2 frames)
+    printf("\nPACKET MODE CHECK\n");
+    char pkt[RXBUFFLEN];
+    char pktStatus;
+    int pktOK=1, pktLen;
+    for(int s=0;s<14*BITQUANTI;s++) SWUART_isr(); //letting the frames of the previous steps end
+    SWUARTclearBuffer(1,'B');
+    SWUARTsetPacket('\n',0,'B');
+    SWUARTsendBuffer("ab\ncd\nef",8,'A');
+    for(int s=0;s<9*12*BITQUANTI;s++) SWUART_isr();
+    if(SWUARTreceivePacket(pkt,RXBUFFLEN,'B',&pktStatus)!=3 || memcmp(pkt,"ab\n",3) || pktStatus!=0) pktOK=0;
+    if(SWUARTreceivePacket(pkt,RXBUFFLEN,'B',&pktStatus)!=3 || memcmp(pkt,"cd\n",3)) pktOK=0;
+    if(SWUARTreceivePacket(pkt,RXBUFFLEN,'B',&pktStatus)!=-EMPTYBUFF) pktOK=0; //"ef" not ended yet
+    SWUARTsetPacket(NODELIM,2*11*BITQUANTI,'B'); //"ef" ended by the change
+    if(SWUARTreceivePacket(pkt,RXBUFFLEN,'B',&pktStatus)!=2 || memcmp(pkt,"ef",2)) pktOK=0;
+    for(int burst=0;burst<2;burst++){ //two bursts, apart more than the gap
+        SWUARTsendBuffer("xyz",3,'A');
+        for(int s=0;s<4*12*BITQUANTI;s++) SWUART_isr();
+        if(SWUARTreceivePacket(pkt,RXBUFFLEN,'B',&pktStatus)!=-EMPTYBUFF) pktOK=0; //gap not over yet
+        for(int s=0;s<2*11*BITQUANTI;s++) SWUART_isr();
+        pktLen=SWUARTreceivePacket(pkt,RXBUFFLEN,'B',&pktStatus);
+        printf("burst %d: packet of %d messages, status %d\n",burst,pktLen,pktStatus);
+        if(pktLen!=3 || memcmp(pkt,"xyz",3) || pktStatus!=0) pktOK=0;
+    }
+    SWUARTsetPacket(NODELIM,0,'B');
+    printf("%s\n",pktOK?"OK":"FAIL");
+    if(!pktOK) return 1;
+#endif
+
+#if UARTEVENTS
+    //EVENTS CHECK (TX drained called inside the ISR for A, messages received and errors dispatched for B)
+    printf("\nEVENTS CHECK\n");
+    char evMsg;
+    int evOK=1;
+    for(int s=0;s<14*BITQUANTI;s++) SWUART_isr(); //letting the frames of the previous steps end
+    SWUARTclearBuffer(1,'B');
+    SWUARTsetCallback(countEvent,EVTXDONE,EVDIRECT,'A');
+    SWUARTsetCallback(countEvent,EVRX|EVERROR,EVDEFERRED,'B');
+    for(int m=0;m<4;m++) SWUARTsend(m,'A',0,0);
+    for(int s=0;s<5*12*BITQUANTI;s++) SWUART_isr();
+    if(evCount[1]!=1 || evCount[0]!=0) evOK=0; //one drain, no RX callback before the dispatch
+    int calls=SWUARTdispatch();
+    if(calls!=1 || evCount[0]!=1 || evCount[2]!=0 || SWUARTdispatch()!=0) evOK=0; //the 4 messages merged into one EVRX
+    printf("4 messages: %d TX drained, %d dispatched RX\n",evCount[1],evCount[0]);
+    for(int m=0;m<RXBUFFLEN+2;m++) SWUARTsend(m,'A',0,0); //overflowing the RX buffer of B
+    for(int s=0;s<(RXBUFFLEN+3)*12*BITQUANTI;s++) SWUART_isr();
+    calls=SWUARTdispatch();
+    if(calls!=2 || evCount[0]!=2 || evCount[2]!=1 || evLastCode!=FULLBUFF) evOK=0;
+    translateErr(evLastCode,guiText);
+    printf("%d messages: %d TX drained, %d dispatched RX, %d errors (last %s)\n",RXBUFFLEN+2,evCount[1],evCount[0],
+            evCount[2],guiText);
+    guiText[0]='\0';
+    while(SWUARTreceive(&evMsg,'B')!=EMPTYBUFF);
+    SWUARTsetCallback(NULL,0,EVDIRECT,'A');
+    SWUARTsetCallback(NULL,0,EVDIRECT,'B');
+    printf("%s\n",(evOK && evCount[1]==2)?"OK":"FAIL");
+    if(!evOK || evCount[1]!=2) return 1;
+#endif
+
+#if TXWAVE && PORTIO //(the wave mode needs the port functions)
+    //TX WAVEFORM CHECK (A rendered into the ring and output by the ISR, then by the emulated DMA: same waveform of the ISR TX)
+    printf("\nTX WAVEFORM CHECK\n");
+    char waveTrace[3][WAVETRACE];
+    int waveOK=1;
+    for(int mode=0;mode<3;mode++){
+        if(!waveRun(mode,waveTrace[mode])) waveOK=0;
+        if(memcmp(waveTrace[mode],waveTrace[0],WAVETRACE)) waveOK=0;
+        printf("mode %d: %s\n",mode,waveOK?"same waveform, received":"FAIL");
+    }
+    if(SWUARTgetWaveUnderruns()!=0) waveOK=0;
+    //rendering only once: the ring runs empty before the frames end
+    for(int s=0;s<14*BITQUANTI;s++) SWUART_isr();
+    SWUARTsetWave(1,'A');
+    SWUARTsendBuffer("ab",2,'A');
+    SWUARTrender();
+    for(int s=0;s<2*WAVELEN;s++) SWUART_isr();
+    unsigned char under=SWUARTgetWaveUnderruns();
+    printf("rendered once: %d underruns\n",under);
+    if(under==0) waveOK=0;
+    while(SWUARTrender()>0) for(int s=0;s<WAVELEN;s++) SWUART_isr(); //rest of the frame (stretched)
+    for(int s=0;s<14*BITQUANTI;s++) SWUART_isr();
+    SWUARTsetWave(0,'A');
+    SWUARTclearBuffer(1,'B');
+    printf("%s\n",waveOK?"OK":"FAIL");
+    if(!waveOK) return 1;
+#endif
+
+#if TICKLESS
+    //TICKLESS CHECK (same traffic with the fixed rate and with the ISR calls programmed by the engine)
+    printf("\nTICKLESS CHECK\n");
+    long fixedCalls, ticklessCalls;
+    unsigned long fixedHash=ticklessRun(0,&fixedCalls,"A",'B');
+    unsigned long ticklessHash=ticklessRun(1,&ticklessCalls,"A",'B');
+    printf("fixed rate: %ld ISR calls in %ld quanti\n",fixedCalls,(long)TICKLESSRUN);
+    printf("tickless: %ld ISR calls in %ld quanti%s\n",ticklessCalls,(long)TICKLESSRUN,EDGERX?"":" (RX lines awake without EDGERX)");
+    int tickOK=fixedHash==ticklessHash && fixedCalls==TICKLESSRUN && (!EDGERX || ticklessCalls<fixedCalls);
+    printf("%s\n",tickOK?"same waveforms and messages, OK":"FAIL");
+    if(!tickOK) return 1;
+#endif
+
+#if UARTSTATS
+    //STATISTICS CHECK (known traffic and line errors from A to B, then the counters reset)
+    printf("\nSTATISTICS CHECK\n");
+    SWUARTstats stA, stB;
+    int stOK=1, stSent=0;
+    SWUARTsetFormat(DEFFORMAT,'A');
+    SWUARTsetFormat(DEFFORMAT,'B');
+    for(int s=0;s<14*BITQUANTI;s++) SWUART_isr(); //letting the frames of the previous steps end
+    SWUARTclearBuffer(1,'B');
+    SWUARTgetStats(&stA,'A',1); //counting from here
+    SWUARTgetStats(&stB,'B',1);
+    for(int m=0;m<TXBUFFLEN;m++) if(SWUARTsend(m,'A',0,0)==0) stSent++; //TX buffer full
+    for(int s=0;s<(TXBUFFLEN+1)*12*BITQUANTI;s++) SWUART_isr();
+    for(int m=0;m<2;m++) if(SWUARTsend(m,'A',0,0)==0) stSent++; //B doesn't read, its RX buffer overflows
+    for(int s=0;s<3*12*BITQUANTI;s++) SWUART_isr();
+    SWUARTclearBuffer(1,'B');
+    statsFrame(0,1,1); //wrong parity
+    statsFrame(0,0,0); //stop violation
+    writePin(0,0); //START glitch shorter than the sample quantum
+    SWUART_isr();
+    writePin(0,1);
+    for(int s=0;s<14*BITQUANTI;s++) SWUART_isr();
+    SWUARTclearBuffer(1,'B');
+    SWUARTgetStats(&stA,'A',1);
+    SWUARTgetStats(&stB,'B',1);
+    for(char name='A';name<='B';name++){
+        SWUARTstats *st=(name=='A')?&stA:&stB;
+        printf("%c: TX %u RX %u parity err %u stop err %u overruns %u false starts %u TX high %u RX high %u\n",name,
+                st->TXframes,st->RXframes,st->parErrors,st->stopErrors,st->overruns,st->falseStarts,st->TXhigh,st->RXhigh);
+    }
+    int over=(TXBUFFLEN+2>RXBUFFLEN)?TXBUFFLEN+2-RXBUFFLEN:0; //messages lost by B
+    if(stSent!=TXBUFFLEN+2 || stA.TXframes!=stSent || stA.TXhigh!=TXBUFFLEN || stA.RXframes!=0) stOK=0;
+    if(stB.RXframes!=stSent+2 || stB.overruns!=over || stB.RXhigh!=stSent-over || stB.TXframes!=0) stOK=0;
+    if(stB.parErrors!=1 || stB.stopErrors!=1 || stB.falseStarts!=1) stOK=0;
+    SWUARTgetStats(&stB,'B',0); //reset by the previous read
+    if(stB.RXframes || stB.overruns || stB.parErrors || stB.stopErrors || stB.falseStarts || stB.RXhigh) stOK=0;
+    printf("%s\n",stOK?"OK":"FAIL");
+    if(!stOK) return 1;
+#endif
+
+#if ISRPROF
+    //ISR PROFILE (readCycles() of the laptop driver counts nanoseconds)
+    SWUARTprof prof;
+    SWUARTgetProfile(&prof);
+    printf("\nISR PROFILE\n");
+    printf("calls: %lu min: %luns max: %luns mean: %luns RX share: %d%%\n",prof.calls,prof.min,prof.max,
+            (unsigned long)(prof.total/prof.calls),(int)(prof.RXtotal*100/prof.total));
+    for(int b=0;b<PROFBINS;b++){
+        if(prof.hist[b]) printf("%6luns+: %lu\n",1UL<<b,prof.hist[b]);
+    }
+#endif
+
     return 0;
 
 
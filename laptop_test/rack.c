@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "SWUART.h"
+#include "SWUART_engine.h"
+#include "SWUART_drivers.h"
+
+/* SHARDED RACK SIMULATION
+ *
+ * Simulates a rack of RACKUARTS links on the emulated GPIO bank (UART u transmits on pin u and receives
+ * from pin u+1+RACKUARTS/2, so most of the wires go between far UARTs) sending pseudo random bursts.
+ * The UARTs are partitioned in shards, each one with its own engine and with the TX pins on its own
+ * ports, and every shard is stepped by its own worker thread. The threads run in lock-step: during
+ * quantum t each shard reads all the pins from the buffer written in quantum t-1 and writes its own
+ * ports to the other buffer (simLockStep() of the laptop driver), then waits the others on a barrier,
+ * so the cross shard wires are exchanged once per quantum. That is exactly what a single engine does
+ * inside one SWUART ISR (all the pins are read before any pin is written), so the result doesn't depend
+ * on the number of threads and it is bit-exact with a single engine of all the UARTs stepped by one thread.
+ * With STAGEDTX the levels staged by each call are flushed before the exchange (SWUARTengineFlushTX()),
+ * as a single engine writes them at the beginning of the next call, before sampling.
+ *
+ * The reference single engine run and the sharded runs with 1, 2, 4... threads are compared on the
+ * received data of each UART and on the waveform of every port, the results are printed as CSV:
+ * threads,uarts,ticks,rx_bytes,seconds,ticks_per_sec,speedup,match
+ *
+ * usage: rack [ticks (default 200000)] [maximum number of threads (default RACKMAXTHREADS)]
+ * (compile with the laptop driver and -DGPIONUM=1024 -lpthread, needs MAXUARTS>=255 and MAXPIN>=1023)
+ */
+
+#define RACKUARTS 1024 //number of simulated UARTs
+#define RACKMAXTHREADS 16 //maximum number of threads (and shards)
+#define PORTPINS 32 //pins of each emulated port of the laptop driver (shards are aligned to ports)
+#define BATCH 64 //quanti between two services of the UART buffers
+#define RACKLEN 16 //RX/TX buffer length of the engines
+#define SPINS 2000 //barrier polls before yielding the core
+#define HASHSEED 14695981039346656037ULL //FNV-1a offset basis
+#define HASHPRIME 1099511628211ULL //FNV-1a prime
+
+#if MAXSLOTS<RACKUARTS || MAXPIN<RACKUARTS-1
+#error "the rack simulation needs MAXUARTS>=255 and MAXPIN>=1023 in SWUART.h"
+#endif
+
+int getGPIONUM(); //number of emulated pins of the laptop test driver
+void simLockStep(portword *in,portword *out); //lock-step mode of the laptop test driver
+extern portword gpio[]; //emulated gpio of the laptop test driver
+
+#define PORTS ((RACKUARTS+PORTPINS-1)/PORTPINS) //number of ports used by the rack
+
+typedef struct{ //shard of the rack, stepped by one thread
+    SWUARTengine eng;
+    int first; //first UART of the shard (UART u of the rack is handle u-first of the shard)
+    int num; //number of UARTs of the shard
+    int firstPort, lastPort; //ports of the TX pins of the shard
+    UARTDS *UARTs;
+    UARTtx *TXstate;
+    RXline *lines;
+    message *RXstore;
+    txmessage *TXstore;
+    sliceword *masks;
+    sliceword *sync;
+} shard;
+
+shard shards[RACKMAXTHREADS];
+int shardNum; //number of shards of the current run
+long runTicks; //quanti of the current run
+portword lockBuff[2][PORTS]; //pins written in the even/odd quanti
+atomic_int tickArrived; //shards arrived at the barrier of the current quantum
+atomic_long tickDone; //number of completed quanti (barrier generation)
+
+unsigned long rng[RACKUARTS]; //pseudo random generator of each UART
+unsigned long long RXhash[RACKUARTS]; //hash of the data received by each UART
+long RXbytes[RACKUARTS]; //bytes received by each UART
+long rackBytes; //bytes received by all the UARTs in the last run
+unsigned long long portHash[PORTS]; //hash of the waveform of each port
+
+static unsigned long long hashByte(unsigned long long h,unsigned char b){
+    return (h^b)*HASHPRIME;
+}
+
+static unsigned long long hashPort(unsigned long long h,portword val){
+    for(int c=0;c<(int)sizeof(portword);c++) h=hashByte(h,(unsigned char)(val>>(8*c)));
+    return h;
+}
+
+//function to create the storage of shard sh with num UARTs starting from UART first, returns 1 if out of memory
+static int shardAlloc(shard *sh,int first,int num){
+    int W=SLICEWORDS(num);
+    sh->first=first;
+    sh->num=num;
+    sh->UARTs=(UARTDS*)malloc(num*sizeof(UARTDS));
+    sh->TXstate=(UARTtx*)malloc(num*sizeof(UARTtx));
+    sh->lines=(RXline*)malloc(num*sizeof(RXline));
+    sh->RXstore=(message*)malloc(num*(RACKLEN+1)*sizeof(message));
+    sh->TXstore=(txmessage*)malloc(num*(RACKLEN+1)*sizeof(txmessage));
+    sh->masks=(sliceword*)malloc(SLICEMASKS(BITQUANTI)*W*sizeof(sliceword));
+    sh->sync=(sliceword*)malloc(SYNCMASKS*W*sizeof(sliceword));
+    return !sh->UARTs || !sh->TXstate || !sh->lines || !sh->RXstore || !sh->TXstore || !sh->masks || !sh->sync;
+}
+
+static void shardFree(shard *sh){
+    free(sh->UARTs); free(sh->TXstate); free(sh->lines); free(sh->RXstore); free(sh->TXstore); free(sh->masks); free(sh->sync);
+}
+
+//function to build the rack with shardNum shards (in normal mode), returns 1 on error
+static int rackBuild(){
+    int per=(RACKUARTS+shardNum-1)/shardNum;
+    per=(per+PORTPINS-1)/PORTPINS*PORTPINS; //whole ports for each shard
+
+    for(int p=0;p<PORTS;p++){
+        gpio[p]=0;
+        portHash[p]=HASHSEED;
+    }
+    for(int u=0;u<RACKUARTS;u++){
+        rng[u]=u*2654435761UL+1;
+        RXhash[u]=HASHSEED;
+        RXbytes[u]=0;
+    }
+
+    for(int s=0;s<shardNum;s++){
+        shard *sh=&shards[s];
+        int first=s*per;
+        int num=(first+per<=RACKUARTS)?per:RACKUARTS-first;
+        if(num<=0 || shardAlloc(sh,first,num)){
+            printf("# can't create shard %d\n",s);
+            return 1;
+        }
+        sh->firstPort=first/PORTPINS;
+        sh->lastPort=(first+num-1)/PORTPINS;
+
+        SWUARTengineInit(&sh->eng,num,RACKLEN,RACKLEN,BITQUANTI,SMPQUANTUM,sh->UARTs,sh->TXstate,sh->lines,
+                sh->RXstore,sh->TXstore,sh->masks,sh->sync);
+        for(int u=first;u<first+num;u++){
+            int ret=SWUARTengineAddUnnamedH(&sh->eng,u,(u+1+RACKUARTS/2)%RACKUARTS); //UARTs without name (more than 255)
+            if(ret!=u-first){
+                printf("# error %d adding UART %d\n",-ret,u);
+                return 1;
+            }
+        }
+    }
+
+    for(int p=0;p<PORTS;p++) lockBuff[0][p]=lockBuff[1][p]=gpio[p]; //pins after the UARTs creation
+    return 0;
+}
+
+//function to service the UARTs of shard sh (burst of 0:RACKLEN pseudo random bytes on each UART, RX buffers emptied)
+static void shardService(shard *sh){
+    char data[RACKLEN];
+    char status[RACKLEN];
+    for(int h=0;h<sh->num;h++){
+        int u=sh->first+h;
+        rng[u]=rng[u]*1103515245UL+12345UL;
+        int len=(rng[u]>>16)%(RACKLEN+1);
+        for(int c=0;c<len;c++) data[c]=(char)(rng[u]>>(c%8+8));
+        SWUARTengineSendBufferH(&sh->eng,data,len,h); //only the free slots are filled
+
+        int r=SWUARTengineReceiveBufferH(&sh->eng,data,RACKLEN,h,status);
+        RXbytes[u]+=r;
+        for(int c=0;c<r;c++){
+            RXhash[u]=hashByte(RXhash[u],(unsigned char)data[c]);
+            RXhash[u]=hashByte(RXhash[u],(unsigned char)status[c]);
+        }
+    }
+}
+
+//barrier at the end of quantum t, spinning for a short time and then yielding (a quantum is a few microseconds)
+static void tickBarrier(long t){
+    if(atomic_fetch_add(&tickArrived,1)==shardNum-1){ //last shard, releasing the others
+        atomic_store(&tickArrived,0);
+        atomic_store(&tickDone,t+1);
+    }else{
+        for(int spin=0;atomic_load(&tickDone)<=t;spin++){
+            if(spin>=SPINS) sched_yield();
+        }
+    }
+}
+
+//worker thread stepping a shard in lock-step with the others
+static void* shardThread(void *arg){
+    shard *sh=(shard*)arg;
+    for(long t=0;t<runTicks;t++){
+        portword *in=lockBuff[t&1];
+        portword *out=lockBuff[(t+1)&1];
+        for(int p=sh->firstPort;p<=sh->lastPort;p++) out[p]=in[p]; //own ports keep their value if not written
+        simLockStep(in,out);
+
+        if(t%BATCH==0) shardService(sh);
+        SWUARTengine_isr(&sh->eng);
+
+        for(int p=sh->firstPort;p<=sh->lastPort;p++) portHash[p]=hashPort(portHash[p],out[p]);
+#if STAGEDTX
+        SWUARTengineFlushTX(&sh->eng); //levels of the next quantum, sampled by its call as in a single engine
+#endif
+        tickBarrier(t); //quantum boundary, all the ports of the quantum written
+    }
+    simLockStep(NULL,NULL);
+    return NULL;
+}
+
+static double nowSec(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+//function to run the rack with threads threads (0 for the reference single engine run), returns the elapsed seconds
+static double rackRun(int threads,long ticks){
+    shardNum=threads?threads:1;
+    runTicks=ticks;
+    if(rackBuild()) exit(1);
+
+    double t0=nowSec();
+    if(threads==0){ //reference: one engine in normal mode, as SWUART_isr() in main.c
+        shard *sh=&shards[0];
+        for(long t=0;t<ticks;t++){
+            if(t%BATCH==0) shardService(sh);
+            SWUARTengine_isr(&sh->eng);
+            for(int p=0;p<PORTS;p++) portHash[p]=hashPort(portHash[p],gpio[p]);
+        }
+    }else{
+        pthread_t tid[RACKMAXTHREADS];
+        atomic_store(&tickArrived,0);
+        atomic_store(&tickDone,0);
+        for(int s=1;s<threads;s++) pthread_create(&tid[s],NULL,shardThread,&shards[s]);
+        shardThread(&shards[0]); //the main thread steps the first shard
+        for(int s=1;s<threads;s++) pthread_join(tid[s],NULL);
+    }
+    double sec=nowSec()-t0;
+
+    rackBytes=0;
+    for(int u=0;u<RACKUARTS;u++) rackBytes+=RXbytes[u];
+    for(int s=0;s<shardNum;s++) shardFree(&shards[s]);
+    return sec;
+}
+
+int main(int argc,char **argv)
+{
+    long ticks=(argc>1)?atol(argv[1]):200000;
+    int maxThreads=(argc>2)?atoi(argv[2]):RACKMAXTHREADS;
+    if(ticks<=0 || maxThreads<1 || maxThreads>RACKMAXTHREADS || getGPIONUM()<RACKUARTS){
+        printf("usage: rack [ticks] [threads (1:%d)] (GPIONUM must be >=%d)\n",RACKMAXTHREADS,RACKUARTS);
+        return 1;
+    }
+
+    static unsigned long long refRX[RACKUARTS];
+    static unsigned long long refPort[PORTS];
+    int errors=0;
+
+    printf("# SWUART rack simulation: BITQUANTI %d SMPQUANTUM %d BITSLICED %d PORTIO %d\n",BITQUANTI,SMPQUANTUM,BITSLICED,PORTIO);
+    printf("threads,uarts,ticks,rx_bytes,seconds,ticks_per_sec,speedup,match\n");
+    double ref=rackRun(0,ticks);
+    memcpy(refRX,RXhash,sizeof(refRX));
+    memcpy(refPort,portHash,sizeof(refPort));
+    printf("0,%d,%ld,%ld,%.3f,%.0f,1.00,ref\n",RACKUARTS,ticks,rackBytes,ref,ticks/ref);
+
+    for(int threads=1;threads<=maxThreads;threads*=2){
+        double sec=rackRun(threads,ticks);
+        int match=!memcmp(refRX,RXhash,sizeof(refRX)) && !memcmp(refPort,portHash,sizeof(refPort));
+        if(!match) errors++;
+        printf("%d,%d,%ld,%ld,%.3f,%.0f,%.2f,%s\n",threads,RACKUARTS,ticks,rackBytes,sec,ticks/sec,ref/sec,match?"OK":"FAIL");
+        fflush(stdout);
+    }
+
+    return errors!=0;
+}
@@ -1,502 +1,2425 @@
-#include "SWUART.h"
+#include "SWUART_engine.h"
+#include <stdint.h>
 
 #define GETFLAG(var,bit) (((var)>>(bit)) & 1) //macro to get the "bit" flag value from variable "var"
 #define SETFLAG(var,bit) var|=(1<<(bit)) //macro to set "bit" flag to 1 in variable "var"
 #define RESETFLAG(var,bit) var&=(~(1<<(bit))) //macro to set "bit" flag to 0 in variable "var"
 
-// -------------------- DATA STRUCTURES --------------------
-//message list element
-typedef struct message{
-  char data;  //the 8 bit data
-  char par;   //parity bit value
-  char flags;   //flags (flag mapping defined with the macros below)
-} message;
+// -------------------- PRIVATE MACROS --------------------
 //message flags position mapping
 #define BLANK_F 0 //blank message
-#define CLEARRX_F 1 //clear RX list at the end of this message TX/RX
+#define CLEARRX_F 1 //clear RX buffer at the end of this message TX/RX
 #define STOPERR_F 2 //stop violation (sampling 0 as stop bit)
-//macro to get message* from void*
-#define GETMSGP(vptr) ((message*)vptr)
-
-
-//UART data structure
-//it contains UART informations
-//and the RX/TX buffers
-typedef struct UARTDS{
-  char UARTname; //name of the UART (char integer value)
-  int TXpin; //TX pin
-  int RXpin; //RX pin
-
-  // ---------- TX ----------
-  message TXbuff[TXBUFFLEN];  //TX buffer
-  list_e TXlist[TXBUFFLEN]; //TX list
-  list_head TXhead; //TX list head
-  list_head TXfreehead; //TX free list head
-
-  message currTX; //currently TX message
-
-  char TXflags; //flags of the UART TX (flag mapping defined with the macros below)
-
-  char TXbit; //currently TX bit
-    /* TXbit values:
-     * 0 - IDLE
-     * 1 - START
-     * 2:9 - DATA BIT
-     * 10 - PARITY
-     * 11 - STOP
-     */
-  char TXquantum; //currently TX bit quantum
-
-  // ---------- RX ----------
-  message RXbuff[RXBUFFLEN];  //RX buffer
-  list_e RXlist[RXBUFFLEN]; //RX list
-  list_head RXhead; //RX list head
-  list_head RXfreehead; //RX free list head
-
-  message currRX; //currently RX message
-
-  char RXflags; //flags of the UART RX (flag mapping defined with the macros below)
-
-  char RXbit; //currently RX bit
-    /* RXbit values:
-     * 0 - IDLE
-     * 1 - START
-     * 2:9 - DATA BIT
-     * 10 - PARITY
-     * 11 - STOP
-     */
-  char RXquantum; //currently RX bit quantum
-
-  char oldVal; //old value of the line (used to detect start falling edge)
-
-} UARTDS;
-//TX/RX fags mapping
-#define ENABLE_F 0 //channel is enabled
-//macro to get UARTDS* from void*
-#define GETUDSP(vptr) ((UARTDS*)vptr)
+#define PARERR_F 3 //parity bit wrong
+#define PKTEND_F 0 //last message of a packet (RX only, TX uses the position for BLANK_F)
+#define PKTCUT_F 1 //packet cut by the RX buffer full (RX only, TX uses the position for CLEARRX_F)
+/* frame word bit mapping (bit n of the frame word is the n-th bit on the line):
+ * START bit, DATA bits (from FRAME_DATA), optional PARITY bit, STOP bits and (TX only) an end marker,
+ * when the end marker is the only bit left the frame has been sent
+ */
+#define FRAME_START 0 //START bit
+#define FRAME_DATA 1 //first DATA bit
+//macros to get the fields of a frame format (see FORMAT() inside SWUART.h)
+#define FMTBITS(f) (((f)&7)+5) //number of DATA bits
+#define FMTPAR(f) (((f)>>3)&3) //parity (PARNONE, PAREVEN or PARODD)
+#define FMTSTOP(f) ((((f)>>5)&1)+1) //number of STOP bits
+#define FMTRXLEN(f) (FRAME_DATA+FMTBITS(f)+(FMTPAR(f)!=PARNONE)+1) //number of bits sampled by RX (START to first STOP)
+//macros to build ring elements and to get their fields
+#define TXMSG(frame,flags) ((txmessage)((frame) | ((flags)<<TXMSGFLAGS))) //TX ring element of frame word and flags
+#define TXMSGFRAME(m) ((unsigned short)((m) & ((1<<TXMSGFLAGS)-1))) //frame word of a TX ring element
+#define RXMSG(data,flags) ((message)((data) | ((flags)<<RXMSGFLAGS))) //RX ring element of data and flags
+#define RXMSGDATA(m) ((unsigned short)((m) & ((1<<RXMSGFLAGS)-1))) //data of a RX ring element
+//macros to get the RX/TX ring of UART u of engine eng
+#define RXRING(eng,u) ((eng)->RXstore+(u)*((eng)->RXbuffLen+1))
+#define TXRING(eng,u) ((eng)->TXstore+(u)*((eng)->TXbuffLen+1))
+//macros to get the RX/TX stamp ring of UART u of engine eng (same slots of the message rings)
+#define RXSTAMPS(eng,u) ((eng)->RXstamps+(u)*((eng)->RXbuffLen+1))
+#define TXSTAMPS(eng,u) ((eng)->TXstamps+(u)*((eng)->TXbuffLen+1))
+//macro to get the ring index following idx inside a ring of len messages (len+1 slots)
+#define RINGNEXT(idx,len) ((idx)==(len) ? 0 : (idx)+1)
+
+/* compiler barrier, the message slots of the rings are written/read before publishing the new
+ * ring index, so that the ISR and the API functions can share the rings without disabling interrupts
+ */
+#if defined(__GNUC__)
+#define MEMBARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define MEMBARRIER()
+#endif
+
+//RX fags mapping
+#define ENABLE_F 0 //channel is enabled (UARTs: attached to a RX line, not TX only)
+#define DROP_F 1 //currently RX message must not be saved
+
+#define NOPORT 0xFF //port index of pins not accessed through the port functions
+#define NOPKTDELIM 0xFFFF //packet delimiter of UARTs without delimiter
+//macro to get the UARTbuffer index of an UARTDS* of engine eng
+#define UARTIDX(eng,uptr) ((int)((uptr)-(UARTDS*)(eng)->UARTbuffer))
+#define SLICEBIT(u) (((sliceword)1)<<((u)%SLICEBITS)) //macro to get the mask of UART u inside its word
+
+//macros to time the ISR (nothing if ISRPROF is not set)
+#if ISRPROF
+#define PROFTIME(t) unsigned long t=readCycles() //reading the counter into a new variable t
+#define PROFRECORD(eng,t0,t1) profRecord(eng,t0,t1,readCycles()) //recording a call started at t0 with RX part over at t1
+#else
+#define PROFTIME(t)
+#define PROFRECORD(eng,t0,t1)
+#endif
+
+//macros to count the UART statistics (nothing if UARTSTATS is not set)
+#if UARTSTATS
+#define STATINC(cnt) do{ if((cnt)!=0xFFFF) (cnt)++; }while(0) //incrementing a counter (saturating)
+#define STATHIGH(mark,num) do{ if((num)>(mark)) (mark)=(num); }while(0) //raising an high-water mark
+#else
+#define STATINC(cnt)
+#define STATHIGH(mark,num)
+#endif
+//macro to raise an event of UART u (nothing if UARTEVENTS is not set)
+#if UARTEVENTS
+#define EVENT(eng,u,event,code) do{ if((eng)->UARTbuffer[u].evMask & (event)) raiseEvent(eng,u,event,code); }while(0)
+#else
+#define EVENT(eng,u,event,code)
+#endif
+//macro to get the number of messages inside a ring of len messages with write index head and read index tail
+#define RINGFILL(head,tail,len) ((unsigned char)(((head)+(len)+1-(tail))%((len)+1)))
 
 // -------------------- GLOBAL VARIABLES --------------------
-// ---------- UART LIST MEMORY SECTIONS ----------
-volatile UARTDS UARTbuffer[MAXUARTS]; //UARTDS objects memory
-volatile list_e UARTlist[MAXUARTS]; //list elements memory
-volatile list_head UARThead; //list head
-volatile list_head UARTfreehead; //free list head
-
-char initCalled=0; //flag to set if init has been called
+// ---------- DEFAULT ENGINE ----------
+//engine of the SWUART.h functions and its storage, sized by the config macros
+SWUARTengine defEngine;
+UARTDS defUARTs[MAXUARTS]; //UARTDS objects memory
+UARTtx defTXstate[MAXUARTS]; //UART TX states memory
+RXline defLines[MAXUARTS]; //RX lines memory
+message defRXstore[MAXUARTS*(RXBUFFLEN+1)]; //RX rings memory
+txmessage defTXstore[MAXUARTS*(TXBUFFLEN+1)]; //TX rings memory
+sliceword defMasks[SLICEMASKS(BITQUANTI)*SLICEWORDS(MAXUARTS)]; //channel masks memory
+volatile sliceword defSync[SYNCMASKS*SLICEWORDS(MAXUARTS)]; //shared channel masks memory
+#if TIMESTAMPS
+swtick defRXstamps[MAXUARTS*(RXBUFFLEN+1)]; //RX stamp rings memory
+swtick defTXstamps[MAXUARTS*(TXBUFFLEN+1)]; //TX stamp rings memory
+#endif
 
 
 //---------- STATIC (MODULE PRIVATE) FUNCTIONS ----------
 
-/* function to reset all the fields of a UARTDS
+//function to get the position of the lowest set bit of a (non zero) word
+static inline int sliceCtz(sliceword w){
+#if defined(__GNUC__)
+    if(sizeof(sliceword)<=sizeof(unsigned int)) return __builtin_ctz((unsigned int)w);
+    return __builtin_ctzll((unsigned long long)w);
+#else
+    int b=0;
+    while(!(w & 1)){
+        w>>=1;
+        b++;
+    }
+    return b;
+#endif
+}
+
+
+#if BITSLICED
+//function to increment the bit-sliced counters selected by mask m inside word cnt (planes W words apart)
+static inline void sliceInc(sliceword *cnt, int W, sliceword m){
+    for(int i=0;i<CNTPLANES && m;i++){ //ripple carry through the planes
+        sliceword carry=cnt[i*W] & m;
+        cnt[i*W]^=m;
+        m=carry;
+    }
+}
+
+//function to get the mask of the bit-sliced counters equal to val inside word cnt (planes W words apart)
+static inline sliceword sliceEq(sliceword *cnt, int W, char val){
+    sliceword ret=~(sliceword)0;
+    for(int i=0;i<CNTPLANES;i++){
+        if(GETFLAG(val,i)) ret&=cnt[i*W];
+        else ret&=~cnt[i*W];
+    }
+    return ret;
+}
+
+//function to get the mask of the bit-sliced counters inside word cnt equal to the bit-sliced values inside word val (planes W words apart)
+static inline sliceword sliceEqv(sliceword *cnt, sliceword *val, int W){
+    sliceword ret=~(sliceword)0;
+    for(int i=0;i<CNTPLANES;i++){
+        ret&=~(cnt[i*W] ^ val[i*W]);
+    }
+    return ret;
+}
+
+//function to set the bit-sliced counters selected by mask m inside word cnt (planes W words apart) to val
+static inline void sliceSet(sliceword *cnt, int W, sliceword m, char val){
+    for(int i=0;i<CNTPLANES;i++){
+        if(GETFLAG(val,i)) cnt[i*W]|=m;
+        else cnt[i*W]&=~m;
+    }
+}
+
+//function to move the UARTs selected by mask m inside word slot of engine eng to the current phase slot
+static inline void sliceSlot(SWUARTengine *eng, sliceword *slot, sliceword m){
+    int W=eng->words;
+    for(int q=0;q<eng->bitQuanti;q++){
+        slot[q*W]&=~m;
+    }
+    slot[eng->slicePhase*W]|=m;
+}
+#endif
+
+//function to compute parity of bits (ret=1 if odd number of 1s)
+static inline char computeParity(unsigned short bits){
+    bits^=bits>>8; //folding the word on itself, the LSB will be the xor of all the bits
+    bits^=bits>>4;
+    bits^=bits>>2;
+    bits^=bits>>1;
+    return bits & 1;
+}
+
+//function to build the frame word of message msg with frame format format
+static unsigned short buildFrame(unsigned short msg, char format){
+    char pos=FRAME_DATA+FMTBITS(format); //position of the bit after DATA
+    unsigned short frame=(msg & ((1<<FMTBITS(format))-1))<<FRAME_DATA; //DATA bits (START is 0)
+    if(FMTPAR(format)!=PARNONE){ //PARITY bit
+        if(computeParity(frame) ^ (FMTPAR(format)==PARODD)) SETFLAG(frame,pos);
+        pos++;
+    }
+    frame|=((1<<(FMTSTOP(format)+1))-1)<<pos; //STOP bits and end marker
+    return frame;
+}
+
+//function to get the data of a received frame word with frame format format
+static inline unsigned short frameData(unsigned short frame, char format){
+    return (frame>>FRAME_DATA) & ((1<<FMTBITS(format))-1);
+}
+
+//function to get the error flags of a received frame word with frame format format (first STOP and PARITY check)
+static char frameErrors(unsigned short frame, char format){
+    char flags=0;
+    char pos=FRAME_DATA+FMTBITS(format); //position of the bit after DATA
+    if(FMTPAR(format)!=PARNONE){
+        //if DATA+PARITY bits are odd (even parity) or even (odd parity)
+        if(computeParity(frame & ((2<<pos)-(1<<FRAME_DATA))) ^ (FMTPAR(format)==PARODD)) SETFLAG(flags,PARERR_F);
+        pos++;
+    }
+    if(!GETFLAG(frame,pos)) SETFLAG(flags,STOPERR_F); //if stop violation
+    return flags;
+}
+
+#if ISRPROF
+//function to record an ISR call of engine eng started at t0, with the RX part over at t1 and the TX part at t2
+static void profRecord(SWUARTengine *eng, unsigned long t0, unsigned long t1, unsigned long t2){
+    SWUARTprof *prof=&eng->prof;
+    unsigned long d=t2-t0; //duration (counter wrap around included)
+
+    prof->last=d;
+    if(prof->calls==0 || d<prof->min) prof->min=d;
+    if(d>prof->max) prof->max=d;
+    prof->total+=d;
+    prof->RXtotal+=t1-t0;
+
+    int bin=0; //log2 of the duration
+    while(bin<PROFBINS-1 && (d>>(bin+1))) bin++;
+    prof->hist[bin]++;
+    prof->calls++;
+}
+#endif
+
+/* function to reset all the fields of a UARTDS and of its TX state
  * by also clearing all the buffers
- * WARNING: to be called after initUARTDS()
  */
-static void resetUARTDS(UARTDS *uart){
-    //resetting name and pins
+static void resetUARTDS(SWUARTengine *eng, UARTDS *uart, UARTtx *tx){
+    //resetting name, pins and format
     uart->UARTname=0;
     uart->RXpin=0;
     uart->TXpin=0;
+    uart->format=DEFFORMAT;
     //resetting flags
-    uart->TXflags=0;
     uart->RXflags=0;
-    //resetting current bits
-    uart->TXbit=0;
-    uart->RXbit=0;
-    //resetting current bit quantum
-    uart->TXquantum=0;
-    uart->RXquantum=0;
-    //resetting old line value
-    uart->oldVal=0;
+    //resetting RX line
+    uart->RXline=0;
+    uart->nextOnLine=0;
+
+    //resetting current frame
+    tx->frame=0;
+    tx->flags=0;
+    //resetting current bit phase and bit length
+    tx->phase=0;
+    tx->bitLen=eng->defBitLen;
+    //resetting port mapping
+    tx->port=NOPORT;
+    tx->mask=0;
+
+    //emptying rings
+    uart->TXhead=0;
+    uart->TXtail=0;
+    uart->TXclrIdx=0;
+    uart->TXclrReq=0;
+    uart->TXclrAck=0;
+    uart->RXhead=0;
+    uart->RXtail=0;
+    uart->RXflushIdx=0;
+    uart->RXflushSeq=0;
+    uart->RXflushAck=0;
+    uart->RXclrReq=0;
+    uart->RXclrAck=0;
+
+#if UARTSTATS
+    //resetting statistics
+    SWUARTstats zero={0,0,0,0,0,0,0,0};
+    uart->stats=zero;
+#endif
+#if PACKETRX
+    //packet mode off
+    uart->pktDelim=NOPKTDELIM;
+    uart->pktGap=0;
+    uart->pktOpen=0;
+#endif
+#if TIMESTAMPS
+    //resetting TX stamps
+    uart->TXenqueued=0;
+    uart->TXstarted=0;
+#endif
+#if UARTEVENTS
+    //removing callback
+    uart->callback=NULL;
+    uart->evMask=0;
+    uart->evMode=EVDIRECT;
+    uart->evPend=0;
+    uart->evAck=0;
+    uart->evCode=0;
+#endif
+}
 
-    mergeList(&(uart->TXhead),&(uart->TXfreehead)); //moving all the TX messages from list to free list
-    mergeList(&(uart->RXhead),&(uart->RXfreehead)); //moving all the RX messages from list to free list
+//function to get the TX ring read index as seen by the producer (API), pending clear included
+static inline unsigned char TXtailAPI(UARTDS *uart){
+    if(uart->TXclrReq!=uart->TXclrAck) return uart->TXclrIdx; //ring will be emptied up to TXclrIdx
+    return uart->TXtail;
 }
 
+//function to get the RX ring read index as seen by the producer (ISR), pending flush included
+static inline unsigned char RXtailISR(UARTDS *uart){
+    if(uart->RXflushSeq!=uart->RXflushAck) return uart->RXflushIdx; //ring will be emptied up to RXflushIdx
+    return uart->RXtail;
+}
 
-/* this function will init an UARTDS struct to its reset values
- * by also initializing the message lists
- *
+//function to apply (from the consumer side, API) the RX flushes requested by the ISR
+static void applyRXflush(UARTDS *uart){
+    while(uart->RXflushAck!=uart->RXflushSeq){
+        unsigned char seq=uart->RXflushSeq; //reading counter before index (index written before counter by ISR)
+        uart->RXtail=uart->RXflushIdx;
+        uart->RXflushAck=seq;
+    }
+}
+
+//function to request (from the producer side, ISR) the flush of all the RX ring messages
+static inline void flushRX(UARTDS *uart){
+    uart->RXflushIdx=uart->RXhead;
+    uart->RXflushSeq++;
+}
+
+/* this function will get the UARTDS of an handle of engine eng
+ * returns NULL if the handle is not valid, otherwise pointer to UARTDS
+ */
+static inline UARTDS* getUARTDS(SWUARTengine *eng, int handle){
+    if(handle<0 || handle>=eng->UARTnum) return NULL; //if UART not created (UARTs are never removed)
+    return (UARTDS*)&eng->UARTbuffer[handle];
+}
+
+//function to get the handle of an UART of engine eng from its name (-1 if name not used)
+static inline int getHandle(SWUARTengine *eng, char UARTname){
+    return (int)eng->nameTable[(unsigned char)UARTname]-1;
+}
+
+/* this function will search (or add) the port of a pin inside the port table of engine eng
+ * and set port index and pin mask, if the pin can't be accessed through the port
+ * functions (or the port table is full) the index will be NOPORT
+ * read flag must be set (1) if the pin will be read by the ISR
  */
-static void initUARTDS(UARTDS *uart){
-    //initializing main lists
-    initList(&(uart->TXhead),NULL,NULL,0,sizeof(message));
-    initList(&(uart->RXhead),NULL,NULL,0,sizeof(message));
+static void mapPinPort(SWUARTengine *eng, int pin, char read, unsigned char *port, portword *mask){
+    *port=NOPORT;
+    *mask=0;
+#if PORTIO
+    unsigned char id,bit;
+    if(getPinPort(pin,&id,&bit)) return; //if pin not accessible through port
+
+    unsigned char p=0;
+    while(p<eng->portNum && eng->portID[p]!=id) p++; //searching port inside table
+    if(p==eng->portNum){ //if port not found
+        if(eng->portNum==MAXPORTS) return; //if table full, pin will be accessed with readPin()/writePin()
+        eng->portID[p]=id; //adding port to table
+        eng->portRead[p]=0;
+        eng->portOutMask[p]=0;
+        eng->portNum++;
+    }
+    if(read) eng->portRead[p]=1;
+
+    *port=p;
+    *mask=((portword)1)<<bit;
+#else
+    (void)eng;
+    (void)pin;
+    (void)read;
+#endif
+}
 
-    //initializing free lists
-    initList(&(uart->TXhead),uart->TXlist,uart->TXbuff,TXBUFFLEN,sizeof(message));
-    initList(&(uart->RXhead),uart->RXlist,uart->RXbuff,RXBUFFLEN,sizeof(message));
+//function to sample the pin of a RX line (from the port snapshot of engine eng if possible)
+static inline char samplePin(SWUARTengine *eng, RXline *line){
+#if PORTIO
+    if(line->RXport!=NOPORT) return (eng->portIn[line->RXport] & line->RXmask)!=0;
+#else
+    (void)eng;
+#endif
+    return readPin(line->RXpin);
+}
 
-    resetUARTDS(uart); //resetting UARTDS
+//function to write the TX pin of UART u (deferred to the end of the ISR of engine eng if possible)
+static inline void outputPin(SWUARTengine *eng, int u, char val){
+#if PORTIO
+    UARTtx *tx=&eng->TXstate[u];
+    if(tx->port!=NOPORT){
+        eng->portOutMask[tx->port]|=tx->mask;
+        if(val) eng->portOutVal[tx->port]|=tx->mask;
+        else eng->portOutVal[tx->port]&=~tx->mask;
+        return;
+    }
+#endif
+#if STAGEDTX
+    eng->TXstage[u/SLICEBITS]|=SLICEBIT(u); //written by the next call
+    if(val) eng->TXstageVal[u/SLICEBITS]|=SLICEBIT(u);
+    else eng->TXstageVal[u/SLICEBITS]&=~SLICEBIT(u);
+#else
+    writePin(eng->UARTbuffer[u].TXpin,val);
+#endif
 }
 
-/* this function will search an UARTDS by name inside a list
- * returns NULL if not found, otherwise pointer to UARTDS
+/* this function will write the TX pins changed by outputPin(): every used port with changed pins is written
+ * once and (STAGEDTX) the staged pins not accessed through the ports are written with writePin()
  */
-static UARTDS* searchUARTDSbyName(char UARTname, list_head *lst){
-    list_e *tmp=GETHEADP(lst); //getting first element
-    UARTDS* retPtr=NULL;
-    if(tmp==NULL) return retPtr; //if list empty
-    else{
-        do{ //looping into full list
-            UARTDS *uptr=GETUDSP(tmp->data); //getting UARTDS* from list element pointer
-            if(uptr->UARTname == UARTname){ //if name correspondence found
-                retPtr=uptr; //return the UARTDS*
+static void writeOutputs(SWUARTengine *eng){
+#if PORTIO
+    //writing all the ports with changed TX pins
+    for(unsigned char p=0;p<eng->portNum;p++){
+        if(eng->portOutMask[p]){
+            writePort(eng->portID[p],eng->portOutMask[p],eng->portOutVal[p]);
+            eng->portOutMask[p]=0;
+        }
+    }
+#endif
+#if STAGEDTX
+    //writing the staged pins
+    for(int w=0;w<eng->words;w++){
+        sliceword m=eng->TXstage[w];
+        if(!m) continue;
+        eng->TXstage[w]=0;
+        while(m){
+            int b=sliceCtz(m);
+            m&=m-1;
+            writePin(eng->UARTbuffer[w*SLICEBITS+b].TXpin,GETFLAG(eng->TXstageVal[w],b));
+        }
+    }
+#else
+    (void)eng; //pins already written by outputPin()
+#endif
+}
+
+#if UARTEVENTS
+/* this function will raise an event of UART u (with its callback enabled for it): a direct callback is
+ * called at once, a deferred event bit is toggled only if not already pending and the UART is queued for
+ * dispatch if it had no pending events (if the queue is full the dispatch will scan all the UARTs)
+ */
+static void raiseEvent(SWUARTengine *eng, int u, char event, char code){
+    UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u];
+    if(uptr->evMode==EVDIRECT){
+        uptr->callback(u,event,code);
+        return;
+    }
+    char pend=uptr->evPend ^ uptr->evAck; //pending events
+    if(code) uptr->evCode=code;
+    if(pend & event) return; //merged with the pending one
+    if(pend==0){ //if UART not queued yet
+        unsigned char next=RINGNEXT(eng->evHead,EVQUEUELEN);
+        if(next!=eng->evTail){ //if queue not full
+            eng->evQueue[eng->evHead]=(slotidx)u;
+            MEMBARRIER();
+            eng->evHead=next;
+        }else{
+            eng->evOverflow=1;
+        }
+    }
+    uptr->evPend^=event;
+}
+
+/* this function will call the deferred callbacks of the pending events of UART u,
+ * returns the number of callbacks called
+ */
+static int dispatchUART(SWUARTengine *eng, int u){
+    UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u];
+    int calls=0;
+    char ev;
+    while((ev=uptr->evPend ^ uptr->evAck)!=0){ //until no events raised while dispatching
+        char code=uptr->evCode;
+        uptr->evAck^=ev; //events seen, new ones will queue the UART again
+        SWUARTcallback callback=uptr->callback;
+        if(callback==NULL) continue; //if callback removed
+        if(ev & EVRX){ callback(u,EVRX,0); calls++; }
+        if(ev & EVERROR){ callback(u,EVERROR,code); calls++; }
+        if(ev & EVTXDONE){ callback(u,EVTXDONE,0); calls++; }
+    }
+    return calls;
+}
+#endif
+
+/* this function will save the RX message msg of a line
+ * into the RX ring of an attached UART u (or clear the RX ring if the UART
+ * has to drop the message or the API requested to drop it)
+ */
+static void saveRX(SWUARTengine *eng, int u, message msg){
+    UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u];
+#if UARTSTATS
+    STATINC(uptr->stats.RXframes);
+    if(GETFLAG(msg,RXMSGFLAGS+PARERR_F)) STATINC(uptr->stats.parErrors);
+    if(GETFLAG(msg,RXMSGFLAGS+STOPERR_F)) STATINC(uptr->stats.stopErrors);
+#endif
+    if(!GETFLAG(uptr->RXflags,DROP_F) && uptr->RXclrReq==uptr->RXclrAck){ //if not clearRX
+        unsigned char next=RINGNEXT(uptr->RXhead,eng->RXbuffLen);
+        unsigned char tail=RXtailISR(uptr);
+        if(next!=tail){//if RX buffer not full
+#if PACKETRX
+            char pktEnd=1; //flag set if the message ends a packet (every message outside packet mode)
+            if(uptr->pktDelim!=NOPKTDELIM || uptr->pktGap){ //if packet mode
+                if(RXMSGDATA(msg)==uptr->pktDelim) msg|=(message)1<<(RXMSGFLAGS+PKTEND_F); //delimiter
+                else if(RINGNEXT(next,eng->RXbuffLen)==tail) msg|=(message)3<<(RXMSGFLAGS+PKTEND_F); //buffer now full, packet cut (PKTEND_F|PKTCUT_F)
+                pktEnd=GETFLAG(msg,RXMSGFLAGS+PKTEND_F);
+                uptr->pktOpen=!pktEnd;
             }
-            tmp=tmp->next;
-        }while(tmp!=UARThead && retPtr==NULL);
+#endif
+            RXRING(eng,u)[uptr->RXhead]=msg; //setting message
+#if TIMESTAMPS
+            if(eng->RXstamps!=NULL) RXSTAMPS(eng,u)[uptr->RXhead]=eng->lineBuffer[uptr->RXline].RXstamp;
+#endif
+
+            MEMBARRIER();
+            uptr->RXhead=next; //putting element into ring
+            STATHIGH(uptr->stats.RXhigh,RINGFILL(next,tail,eng->RXbuffLen));
+#if UARTEVENTS
+#if PACKETRX
+            if(pktEnd) EVENT(eng,u,EVRX,0); //(once for each packet)
+#else
+            EVENT(eng,u,EVRX,0);
+#endif
+            if(GETFLAG(msg,RXMSGFLAGS+STOPERR_F)) EVENT(eng,u,EVERROR,STOPERR);
+            else if(GETFLAG(msg,RXMSGFLAGS+PARERR_F)) EVENT(eng,u,EVERROR,PARERR);
+#endif
+        }else{
+            STATINC(uptr->stats.overruns); //message lost
+            EVENT(eng,u,EVERROR,FULLBUFF);
+        }
+    }else{
+        flushRX(uptr); //clearing the RX ring
+    }
+}
 
+//function to deliver the RX frame word of a line to all the attached UARTs
+static void deliverRX(SWUARTengine *eng, RXline *line, unsigned short frame){
+    message msg=RXMSG(frameData(frame,line->format),frameErrors(frame,line->format)); //checking the frame
+#if PACKETRX
+    char gap=0; //flag set if an UART has a packet to be ended by the idle gap
+#endif
+    for(slotidx u=line->firstUART;u!=0;u=eng->UARTbuffer[u-1].nextOnLine){
+        if(GETFLAG(eng->UARTbuffer[u-1].RXflags,ENABLE_F)) saveRX(eng,u-1,msg);
+#if PACKETRX
+        if(eng->UARTbuffer[u-1].pktOpen && eng->UARTbuffer[u-1].pktGap) gap=1;
+#endif
+    }
+#if PACKETRX
+    if(gap){ //counting the idle quanti from the end of this frame
+        int l=(int)(line-eng->lineBuffer);
+        line->gapCnt=0;
+        eng->RXgap[l/SLICEBITS]|=SLICEBIT(l);
     }
-    return retPtr;
- }
+#endif
+}
 
-//function to compute parity of message msg (ret=1 if odd number of 1s)
-static char computeParity(char msg){
-    char retVal=0;
-    for(int b=0;b<8;b++){
-        retVal+=msg>>b; //summing each bit of message to retVal LSB
+#if PACKETRX
+//function to end the open packet of UART u, marking the last message of its RX ring
+static void closePacket(SWUARTengine *eng, int u){
+    UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u];
+    uptr->pktOpen=0;
+    if(uptr->RXhead!=RXtailISR(uptr)){ //if the ring still holds the packet
+        unsigned char last=(uptr->RXhead==0)?eng->RXbuffLen:uptr->RXhead-1;
+        RXRING(eng,u)[last]|=(message)1<<(RXMSGFLAGS+PKTEND_F);
+        EVENT(eng,u,EVRX,0);
     }
-    retVal &= 1; //mask to extract only LSB
-    return retVal;
 }
 
-// ---------- PUBLIC FUNCTIONS ----------
+/* this function will count an idle quantum on line l (inside RXgap), ending the open packets of the UARTs
+ * whose gap is over, the line leaves RXgap when no UART has an open packet left
+ */
+static void gapRX(SWUARTengine *eng, int l){
+    RXline *line=&eng->lineBuffer[l];
+    char open=0; //flag set if some packets are still open
+    line->gapCnt++;
+    for(slotidx u=line->firstUART;u!=0;u=eng->UARTbuffer[u-1].nextOnLine){
+        UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u-1];
+        if(!uptr->pktOpen || !uptr->pktGap) continue;
+        if(line->gapCnt>=uptr->pktGap) closePacket(eng,u-1);
+        else open=1;
+    }
+    if(!open) eng->RXgap[l/SLICEBITS]&=~SLICEBIT(l);
+}
+#endif
+
+//function to prepare all the UARTs attached to a line for a new message (START condition)
+static void startRX(SWUARTengine *eng, RXline *line){
+#if TIMESTAMPS
+    line->RXstamp=eng->ticks; //START detection quantum
+#endif
+#if PACKETRX
+    line->gapCnt=0; //idle gap broken
+#endif
+    for(slotidx u=line->firstUART;u!=0;u=eng->UARTbuffer[u-1].nextOnLine){
+        UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u-1];
+        RESETFLAG(uptr->RXflags,DROP_F);
+        uptr->RXclrAck=uptr->RXclrReq; //older drop requests don't apply to this message
+    }
+}
 
-void SWUARTinit(){
-    if(initCalled == 1){ //if already init, return 1
-        return;
+#if UARTSTATS
+//function to count a false START bit (not LOW at its sample) on all the UARTs attached to a line
+static void falseStartRX(SWUARTengine *eng, RXline *line){
+    for(slotidx u=line->firstUART;u!=0;u=eng->UARTbuffer[u-1].nextOnLine){
+        if(GETFLAG(eng->UARTbuffer[u-1].RXflags,ENABLE_F)) STATINC(eng->UARTbuffer[u-1].stats.falseStarts);
     }
+}
+#endif
 
-    //initializing data
-    for(int u=0;u<MAXUARTS;u++){
-        initUARTDS((UARTDS *)&UARTbuffer[u]); //initializing all the UART structs inside memory
+#if EDGERX
+/* this function will put an idle (HIGH) RX line to sleep until the falling edge of the next START bit
+ * if the pin can't generate edge interrupts, the line will not try to sleep anymore
+ *
+ * return:
+ * 1 - line sleeping
+ * 0 - line must still be sampled
+ */
+static char sleepRX(SWUARTengine *eng, RXline *line, int l){
+    if(armEdge(line->RXpin,l)){ //if pin can't generate edge interrupts
+        eng->RXedge[l/SLICEBITS]&=~SLICEBIT(l);
+        return 0;
     }
+    if(readPin(line->RXpin)==0) return 0; //if line fell before arming, START must be detected by sampling
 
-    //creating lists
-    initList((list_e **)&UARThead,NULL,NULL,0,sizeof(UARTDS)); //initializing empty uart list
-    initList((list_e **)&UARTfreehead,(list_e*)UARTlist,(UARTDS *)UARTbuffer,MAXUARTS,sizeof(UARTDS)); //initializing full free list
+    eng->RXsleep[l/SLICEBITS]|=SLICEBIT(l); //(a wake from an edge after arming is applied by the next ISR)
+    return 1;
+}
+#endif
 
-    initCalled=1;
+/* this function will attach an UART to the RX line of its RXpin, bit length and frame format, by creating
+ * the line (or reusing an unused one) if no other UART receives from the same pin with the same timing/format
+ * WARNING: to be called with interrupts disabled
+ */
+static void attachRXline(SWUARTengine *eng, UARTDS *uptr){
+    UARTtx *tx=&eng->TXstate[UARTIDX(eng,uptr)];
+    slotidx lineNum=eng->lineNum;
+    slotidx l=lineNum; //line of the UART
+    slotidx freeLine=lineNum; //first unused line
+    char shared=0; //flag set if the pin is also decoded by lines with other bit lengths/formats
+    for(slotidx i=0;i<lineNum;i++){ //searching line of RXpin, bitLen and format
+        RXline *tmp=&eng->lineBuffer[i];
+        if(tmp->firstUART==0){
+            if(freeLine==lineNum) freeLine=i;
+        }else if(tmp->RXpin==uptr->RXpin){
+            if(tmp->bitLen==tx->bitLen && tmp->format==uptr->format) l=i;
+            else shared=1;
+        }
+    }
 
-    setupTimer(); //setup timer (and relative ISR)
-    startTimer(); //starting timer
+    RXline *line;
+    if(l==lineNum){ //if not found, creating a new line
+        l=freeLine;
+        line=&eng->lineBuffer[l];
+        line->RXpin=uptr->RXpin;
+        line->firstUART=0;
+        line->RXbit=0;
+        line->RXphase=0;
+        line->RXframe=0; //no stale bits (the storage of the engines may not be zeroed)
+#if TIMESTAMPS
+        line->RXstamp=0;
+#endif
+        line->bitLen=tx->bitLen;
+        line->smpPhase=(unsigned short)(((unsigned long)tx->bitLen*eng->smpQuantum)/eng->bitQuanti);
+        line->format=uptr->format;
+        line->RXlen=FMTRXLEN(uptr->format);
+        line->oldVal=readPin(uptr->RXpin); //reading old line value for rx
+        mapPinPort(eng,uptr->RXpin,1,&(line->RXport),&(line->RXmask)); //mapping pin on port
+        line->RXflags=0;
+        SETFLAG(line->RXflags,ENABLE_F); //enabling line
+        eng->RXen[l/SLICEBITS]|=SLICEBIT(l);
+#if EDGERX
+        if(eng->edge) eng->RXedge[l/SLICEBITS]|=SLICEBIT(l); //line will sleep when idle
+#endif
+#if BITSLICED
+        if(line->oldVal) eng->RXold[l/SLICEBITS]|=SLICEBIT(l);
+        else eng->RXold[l/SLICEBITS]&=~SLICEBIT(l);
+        sliceSet(eng->RXend+l/SLICEBITS,eng->words,SLICEBIT(l),line->RXlen+1);
+#endif
+        if(l==lineNum) eng->lineNum++;
+    }else{
+        line=&eng->lineBuffer[l];
+#if BITSLICED
+        char busy=GETFLAG(eng->RXbusy[l/SLICEBITS],l%SLICEBITS);
+#else
+        char busy=(line->RXbit!=0);
+#endif
+        if(busy) SETFLAG(uptr->RXflags,DROP_F); //the message currently RX on the line is not for the new UART
+    }
 
-    return;
+    if(shared){ //a pin edge can only wake one line (EDGERX), all the lines of the pin will be sampled every quantum
+        for(slotidx i=0;i<eng->lineNum;i++){
+            if(eng->lineBuffer[i].RXpin==uptr->RXpin && (eng->lineBuffer[i].firstUART!=0 || i==l)){
+                eng->RXedge[i/SLICEBITS]&=~SLICEBIT(i);
+                eng->RXsleep[i/SLICEBITS]&=~SLICEBIT(i);
+            }
+        }
+    }
 
+    //attaching UART to the line tail
+    uptr->RXline=l;
+    uptr->nextOnLine=0;
+    if(line->firstUART==0){
+        line->firstUART=UARTIDX(eng,uptr)+1;
+    }else{
+        slotidx u=line->firstUART;
+        while(eng->UARTbuffer[u-1].nextOnLine!=0) u=eng->UARTbuffer[u-1].nextOnLine;
+        eng->UARTbuffer[u-1].nextOnLine=UARTIDX(eng,uptr)+1;
+    }
 }
 
-int SWUARTadd(int TXpin,int RXpin, char UARTname){
-    int retVal=0;
-    if(initCalled == 0){ //if swuart not initialized
-        return NOINIT;
+/* this function will detach an UART from its RX line, disabling the line if no other UART is attached
+ * WARNING: to be called with interrupts disabled
+ */
+static void detachRXline(SWUARTengine *eng, UARTDS *uptr){
+    slotidx l=uptr->RXline;
+    RXline *line=&eng->lineBuffer[l];
+    slotidx self=UARTIDX(eng,uptr)+1;
+
+    //removing UART from the line chain
+    if(line->firstUART==self){
+        line->firstUART=uptr->nextOnLine;
+    }else{
+        slotidx u=line->firstUART;
+        while(eng->UARTbuffer[u-1].nextOnLine!=self) u=eng->UARTbuffer[u-1].nextOnLine;
+        eng->UARTbuffer[u-1].nextOnLine=uptr->nextOnLine;
     }
+    uptr->nextOnLine=0;
+#if PACKETRX
+    if(uptr->pktOpen) closePacket(eng,UARTIDX(eng,uptr)); //the gap is not counted on the new line
+#endif
+
+    if(line->firstUART==0){ //if line unused, disabling it
+        RESETFLAG(line->RXflags,ENABLE_F);
+        eng->RXen[l/SLICEBITS]&=~SLICEBIT(l);
+        eng->RXsleep[l/SLICEBITS]&=~SLICEBIT(l);
+#if PACKETRX
+        eng->RXgap[l/SLICEBITS]&=~SLICEBIT(l);
+#endif
+#if BITSLICED
+        eng->RXbusy[l/SLICEBITS]&=~SLICEBIT(l);
+#endif
+    }
+}
 
-    disableInt();
+/* this function will move the next message of the TX ring of UART u
+ * into its currently TX message (handling the CLEARRX flag)
+ *
+ * return:
+ * 1 - message moved, transmission can start
+ * 0 - TX ring empty
+ */
+static char startTX(SWUARTengine *eng, int u){
+    UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u];
+    UARTtx *tx=&eng->TXstate[u];
+    if(uptr->TXclrAck!=uptr->TXclrReq){ //if API requested to clear the TX ring
+        uptr->TXclrAck=uptr->TXclrReq;
+        uptr->TXtail=uptr->TXclrIdx;
+    }
+    if(uptr->TXtail==uptr->TXhead) return 0; //if no message to send
+
+    txmessage msg=TXRING(eng,u)[uptr->TXtail]; //getting message
+
+    //copying message into currently TX message
+    tx->frame=TXMSGFRAME(msg);
+    tx->flags=msg>>TXMSGFLAGS;
+#if UARTSTATS
+    if(!GETFLAG(tx->flags,BLANK_F)) STATINC(uptr->stats.TXframes);
+#endif
+#if TIMESTAMPS
+    if(!GETFLAG(tx->flags,BLANK_F) && eng->TXstamps!=NULL){
+        uptr->TXenqueued=TXSTAMPS(eng,u)[uptr->TXtail];
+        uptr->TXstarted=eng->ticks; //START bit is written in this quantum
+    }
+#endif
+
+    MEMBARRIER();
+    uptr->TXtail=RINGNEXT(uptr->TXtail,eng->TXbuffLen); //freeing ring slot
+
+    //if CLEARRX_F, clearing RX buffer
+    if(GETFLAG(tx->flags,CLEARRX_F)){
+#if TXWAVE
+        if(eng->TXwave[u/SLICEBITS] & SLICEBIT(u)){ //if rendered (API side), clearing as SWUARTclearBuffer()
+            applyRXflush(uptr);
+            uptr->RXtail=uptr->RXhead;
+            uptr->RXclrReq++;
+            return 1;
+        }
+#endif
+        SETFLAG(uptr->RXflags,DROP_F); //setting current RX message to clear
+        flushRX(uptr); //clearing the RX ring
+    }
+    return 1;
+}
 
-    if(UARTfreehead==NULL){ //if list full
-        retVal=FULLBUFF;
+#define TXIDLE 2 //stepTX() value of an UART with no message to send
+
+/* this function will advance the TX state machine of UART u by step quanti (starting the next message
+ * of its TX ring when IDLE), step must not go past the next bit change
+ *
+ * return:
+ * -1 - output not changed
+ * 0/1 - output value
+ * TXIDLE - IDLE with the TX ring empty (line HIGH)
+ */
+static inline char stepTX(SWUARTengine *eng, int u, unsigned char step){
+    UARTtx *tx=&eng->TXstate[u]; //getting the UART TX state pointer
+    char outVal=-1; //value to be written as output
+
+    //advancing phase by step quanti
+    tx->phase+=(unsigned short)(step<<8);
+
+    if(tx->frame!=0){ //IF NOT IDLE
+        if(tx->phase >= tx->bitLen){ //if it's time to change output
+            tx->phase-=tx->bitLen; //keeping the fractional part of the phase
+
+            if(tx->frame==1){ //if only the end marker is left (stop over)
+                tx->frame=0; //return to IDLE
+            }else{ //shifting out next bit
+                outVal=tx->frame & 1;
+                tx->frame>>=1;
+            }
+        }
     }
 
-    if(!retVal){ //if no errors occurred, searching if name or pins already used
-        list_e *tmp=UARThead; //pointer to list element
-        if(tmp!=NULL){ //if list not empty
-            UARTDS *uptr; //pointer to UARTDS
+    if(tx->frame==0){ //IF IDLE
+        if(startTX(eng,u)){ //if some message to send
+            tx->phase=0; //resetting phase
+            outVal=tx->frame & 1; //shifting out START
+            tx->frame>>=1;
+        }else{
+            outVal=TXIDLE;
+        }
+    }
+    return outVal;
+}
 
-            do{ //looping into full list
-                uptr=GETUDSP(tmp->data);
-                if(uptr->UARTname == UARTname){
-                    retVal=NAMEERR;
-                }else if(uptr->TXpin == TXpin){
-                    retVal=TXUSED;
-                }
+#if TXWAVE
+/* this function will output the waveform ring slot of this quantum of engine eng (with the other TX pins),
+ * if render didn't write it in time the slot is written with the last word, so the pins hold their level
+ */
+static void waveTick(SWUARTengine *eng){
+    unsigned char out=(unsigned char)(eng->waveOut+1);
+    unsigned char in=eng->waveIn;
+    volatile portword *slot=&eng->waveBuf[out%WAVELEN];
+
+    if(eng->waveDry && in!=eng->waveDryIn) eng->waveDry=0; //if render wrote new slots since the ring was found empty
+    if(!eng->waveDry && (signed char)(in-out)>0){ //if slot rendered
+        portword word=*slot;
+#if PORTIO
+        if(!eng->waveDMA && word!=eng->waveLast){ //if levels changed and not output by the DMA
+            eng->portOutMask[eng->wavePort]|=eng->waveMask;
+            eng->portOutVal[eng->wavePort]=(eng->portOutVal[eng->wavePort] & ~eng->waveMask) | (word & eng->waveMask);
+        }
+#endif
+        eng->waveLast=word;
+    }else{ //ring empty
+        *slot=eng->waveLast; //holding the levels
+        eng->waveDry=1;
+        eng->waveDryIn=in;
+        if(eng->waveBusy) eng->waveUnder++; //if frames were waiting to be rendered
+    }
+    eng->waveOut=out;
+}
+#endif
 
-                tmp=tmp->next;
-            }while(tmp!=UARThead && !retVal);
+#if TICKLESS
+/* this function will compute the quanti from this isr call of engine eng to the next one with some work:
+ * 1 while a RX line is awake (mid-frame, or waiting for a START without the edge interrupt), a kick or a wake
+ * is pending or some output is staged, otherwise the quanti to the next TX bit change (at most MAXTICKSTEP).
+ * New messages and START edges bring the next call forward with wakeTick()
+ */
+static unsigned char nextTick(SWUARTengine *eng){
+    int W=eng->words;
+    unsigned short next=MAXTICKSTEP;
+#if PORTIO && STAGEDTX
+    for(unsigned char p=0;p<eng->portNum;p++){
+        if(eng->portOutMask[p]) return 1; //if staged outputs
+    }
+#endif
+#if TXWAVE
+    if(eng->waveMask) return 1; //if waveform ring output (one word per quantum)
+#endif
+    for(int w=0;w<W;w++){
+        if(eng->RXen[w] & ~eng->RXsleep[w]) return 1; //if awake lines
+        if(eng->TXkick[w]!=eng->TXkickAck[w]) return 1; //if UARTs kicked by API
+#if EDGERX
+        if(eng->RXwake[w]!=eng->RXwakeAck[w]) return 1; //if lines woken by START edge
+#endif
+#if PACKETRX
+        if(eng->RXgap[w]) return 1; //if idle gaps being counted
+#endif
+#if STAGEDTX
+        if(eng->TXstage[w]) return 1; //if staged outputs
+#endif
+#if BITSLICED
+        if(eng->TXpend[w] & ~eng->TXbusy[w] & eng->TXen[w]) return 1; //if UARTs starting a message
+#else
+        for(sliceword m=eng->TXact[w];m;m&=m-1){ //quanti to the next bit change of each busy UART
+            UARTtx *tx=&eng->TXstate[w*SLICEBITS+sliceCtz(m)];
+            unsigned short k=(unsigned short)((tx->bitLen-tx->phase+255)>>8);
+            if(k<next) next=k;
+        }
+#endif
+    }
+#if BITSLICED
+    //quanti to the next phase slot of busy UARTs (slicePhase is the phase of the next quantum)
+    for(unsigned short k=1;k<next && k<=eng->bitQuanti;k++){
+        sliceword *slot=eng->TXslot+((eng->slicePhase+k-1)%eng->bitQuanti)*W;
+        for(int w=0;w<W;w++){
+            if(eng->TXbusy[w] & slot[w]) return (unsigned char)k;
+        }
+    }
+#endif
+    return (unsigned char)next;
+}
+#endif
+
+/* function to notify the ISR that the TX ring of an UART is not empty (called by API after
+ * publishing a message), the kick bit is toggled only if no kick is already pending
+ */
+static void kickTX(SWUARTengine *eng, UARTDS *uart){
+    int u=UARTIDX(eng,uart);
+    if(!((eng->TXkick[u/SLICEBITS] ^ eng->TXkickAck[u/SLICEBITS]) & SLICEBIT(u))) eng->TXkick[u/SLICEBITS]^=SLICEBIT(u);
+}
+
+#if TICKLESS
+//function to bring the next isr call of engine eng forward to the next quantum (if it programs its calls), so
+//a message sent while the engine sleeps starts as with the fixed rate
+static void wakeISR(SWUARTengine *eng){
+    if(!eng->tickless) return;
+    disableInt(); //(the timer and tickStep written together)
+    eng->tickStep=wakeTick();
+    enableInt();
+}
+#define WAKEISR(eng) wakeISR(eng)
+#else
+#define WAKEISR(eng)
+#endif
+
+#if TIMESTAMPS
+//function to read the quantum counter of engine eng from the API (read again if the isr changed it meanwhile)
+static swtick readTicks(SWUARTengine *eng){
+    swtick t;
+    do{
+        t=eng->ticks;
+    }while(t!=eng->ticks);
+    return t;
+}
+#endif
+
+/* this function will wait for an isr call of engine eng after the one that set its counter to seq,
+ * idling the CPU with waitTick() if available, returns the number of quanti passed
+ */
+static unsigned char waitISR(SWUARTengine *eng, unsigned char seq){
+    unsigned char now;
+    while((now=eng->tickSeq)==seq){
+#if WAITTICK
+        waitTick();
+#endif
+    }
+    return (unsigned char)(now-seq);
+}
+
+// ---------- ENGINE FUNCTIONS ----------
+
+void SWUARTengineInit(SWUARTengine *eng, int maxUARTs, unsigned char RXbuffLen, unsigned char TXbuffLen,
+        unsigned char bitQuanti, unsigned char smpQuantum, UARTDS *UARTs, UARTtx *TXstate, RXline *lines,
+        message *RXstore, txmessage *TXstore, sliceword *masks, volatile sliceword *sync){
+    //setting sizes and storage
+    eng->UARTbuffer=UARTs;
+    eng->TXstate=TXstate;
+    eng->lineBuffer=lines;
+    eng->RXstore=RXstore;
+    eng->TXstore=TXstore;
+    eng->maxUARTs=maxUARTs;
+    eng->RXbuffLen=RXbuffLen;
+    eng->TXbuffLen=TXbuffLen;
+    eng->bitQuanti=bitQuanti;
+    eng->smpQuantum=smpQuantum;
+    eng->defBitLen=(unsigned short)(bitQuanti<<8);
+    eng->edge=0;
+    eng->tickSeq=0;
+#if TICKLESS
+    eng->tickStep=1;
+    eng->tickless=0; //fixed rate until SWUARTinit() (only the default engine uses the timer functions)
+#endif
+#if TIMESTAMPS
+    eng->ticks=0;
+    eng->RXstamps=NULL; //no stamps until SWUARTengineSetStamps()
+    eng->TXstamps=NULL;
+#endif
+#if UARTEVENTS
+    eng->evHead=0; //no deferred events
+    eng->evTail=0;
+    eng->evOverflow=0;
+#endif
+#if TXWAVE
+    eng->waveMask=0; //no wave UARTs
+    eng->waveDMA=0;
+    eng->waveBusy=0;
+    eng->waveUnder=0;
+    eng->waveUnderAck=0;
+#endif
+
+    //initializing data
+    for(int u=0;u<maxUARTs;u++){
+        resetUARTDS(eng,&UARTs[u],&TXstate[u]); //initializing all the UART structs inside memory
+    }
+    for(int n=0;n<256;n++) eng->nameTable[n]=0; //no names used
+
+#if ISRPROF
+    SWUARTengineResetProfile(eng); //empty profile
+#endif
+
+    eng->UARTnum=0; //no UARTs
+    eng->lineNum=0; //no RX lines
+#if PORTIO
+    eng->portNum=0; //no ports
+#endif
+
+    //assigning the masks to the storage (all channels disabled)
+    int W=SLICEWORDS(maxUARTs);
+    eng->words=W;
+    for(int w=0;w<SLICEMASKS(bitQuanti)*W;w++) masks[w]=0;
+    for(int w=0;w<SYNCMASKS*W;w++) sync[w]=0;
+    eng->RXen=masks;
+    eng->RXedge=masks+W;
+    eng->RXsleep=masks+2*W;
+    eng->TXen=masks+3*W;
+    eng->RXwake=sync;
+    eng->RXwakeAck=sync+W;
+    eng->TXkick=sync+2*W;
+    eng->TXkickAck=sync+3*W;
+#if !BITSLICED
+    eng->TXact=masks+4*W;
+#if PACKETRX
+    eng->RXgap=masks+5*W;
+#endif
+#if STAGEDTX
+    eng->TXstage=masks+(5+PACKETRX)*W;
+    eng->TXstageVal=eng->TXstage+W;
+#endif
+#if TXWAVE
+    eng->TXwave=masks+(5+PACKETRX+2*STAGEDTX)*W;
+#endif
+#else
+    eng->RXbusy=masks+4*W;
+    eng->RXold=masks+5*W;
+    eng->TXbusy=masks+6*W;
+    eng->TXpend=masks+7*W;
+    eng->TXblank=masks+8*W;
+    eng->RXslot=masks+9*W;
+    eng->TXslot=eng->RXslot+bitQuanti*W;
+    eng->RXcnt=eng->TXslot+bitQuanti*W;
+    eng->RXsh=eng->RXcnt+CNTPLANES*W;
+    eng->RXend=eng->RXsh+SHPLANES*W;
+    eng->TXcnt=eng->RXend+CNTPLANES*W;
+    eng->TXsh=eng->TXcnt+CNTPLANES*W;
+    eng->TXend=eng->TXsh+SHPLANES*W;
+#if PACKETRX
+    eng->RXgap=eng->TXend+CNTPLANES*W;
+#endif
+#if STAGEDTX
+    eng->TXstage=eng->TXend+(CNTPLANES+PACKETRX)*W;
+    eng->TXstageVal=eng->TXstage+W;
+#endif
+#if TXWAVE
+    eng->TXwave=eng->TXend+(CNTPLANES+PACKETRX+2*STAGEDTX)*W;
+#endif
+    eng->slicePhase=0;
+#endif
+
+    eng->initCalled=1;
+}
+
+int SWUARTengineGetHandle(SWUARTengine *eng, char UARTname){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return -NOINIT;
+    }
+    int handle=getHandle(eng,UARTname);
+    if(handle<0) return -NAMEERR; //if name not used
+    return handle;
+}
+
+/* this function will create an UART of engine eng, with name UARTname if named is set, otherwise without
+ * name (only addressed by its handle), returns its handle or the negative error code
+ */
+static int addUART(SWUARTengine *eng, int TXpin,int RXpin, char UARTname, char named){
+    int retVal=0;
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return -NOINIT;
+    }
+
+    if(TXpin<0 || TXpin>MAXPIN || (RXpin<0 && RXpin!=NORXPIN) || RXpin>MAXPIN) return -PINERR; //if pins can't be stored
+
+    disableInt();
+
+    if(eng->UARTnum==eng->maxUARTs){ //if all UARTs used
+        retVal=FULLBUFF;
+    }else if(named && getHandle(eng,UARTname)>=0){ //if name already used
+        retVal=NAMEERR;
+    }else{ //searching if TX pin already used
+        for(int u=0;u<eng->UARTnum && !retVal;u++){
+            if(eng->UARTbuffer[u].TXpin == TXpin) retVal=TXUSED;
         }
     }
 
     if(!retVal){ //if no errors occurred, creating the UART
-        list_e *tmp=removeHead((list_head*)&UARTfreehead); //removing element from free list
+        int u=eng->UARTnum; //UARTs are never removed, so the first unused one is the next
         //setting the new UART
-        UARTDS *uptr=GETUDSP(tmp->data); //getting pointer to UARTDS
+        UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u]; //getting pointer to UARTDS
+        UARTtx *tx=&eng->TXstate[u];
 
-        resetUARTDS(uptr); //resetting uart
+        resetUARTDS(eng,uptr,tx); //resetting uart
 
-        uptr->UARTname=UARTname; //setting name
+        if(named) uptr->UARTname=UARTname; //setting name
         uptr->TXpin=TXpin; //setting TX pin
-        uptr->RXpin=RXpin; //setting RX pin
-        //setting pin modes
+        //setting TX pin mode
         setPinMode(TXpin,'O');
         writePin(TXpin,1);
-        setPinMode(RXpin,'I');
-        //reading old line value for rx
-        uptr->oldVal=readPin(RXpin);
+        //mapping TX pin on port
+        mapPinPort(eng,TXpin,0,&(tx->port),&(tx->mask));
+        if(RXpin!=NORXPIN){ //if not TX only
+            uptr->RXpin=RXpin; //setting RX pin
+            setPinMode(RXpin,'I');
+            //attaching UART to the RX line of its pin
+            attachRXline(eng,uptr);
+            SETFLAG(uptr->RXflags,ENABLE_F);
+        }
+
+        //enabling UART TX channel
+        eng->TXen[u/SLICEBITS]|=SLICEBIT(u);
 
-        //enabling UART channels
-        SETFLAG(uptr->TXflags,ENABLE_F);
-        SETFLAG(uptr->RXflags,ENABLE_F);
+        eng->UARTnum++; //adding uart
+        if(named) eng->nameTable[(unsigned char)UARTname]=u+1; //adding name to table
 
-        appendTail((list_head*)&UARThead,tmp); //adding uart to list
+        retVal=u; //returning handle
+    }else{
+        retVal=-retVal; //returning error
     }
 
     enableInt();
 
-    if(!retVal) SWUARTsend(0,UARTname,0,1); //sending a blank message to let the receiver synchronize
-    
+    if(retVal>=0) SWUARTengineSendWordH(eng,0,retVal,0,1); //sending a blank message to let the receiver synchronize
+
     return retVal;
 }
 
-int SWUARTsend(char msg, char UARTname, char clearRX, char blank){
+int SWUARTengineAddH(SWUARTengine *eng, int TXpin,int RXpin, char UARTname){
+    return addUART(eng,TXpin,RXpin,UARTname,1);
+}
+
+int SWUARTengineAddUnnamedH(SWUARTengine *eng, int TXpin,int RXpin){
+    return addUART(eng,TXpin,RXpin,0,0);
+}
+
+int SWUARTengineSendWordH(SWUARTengine *eng, unsigned short msg, int handle, char clearRX, char blank){
     int retVal=0;
-    if(initCalled == 0){ //if swuart not initialized
+    if(eng->initCalled == 0){ //if swuart not initialized
         return NOINIT;
     }
 
-    disableInt();
-
-    UARTDS *uart=searchUARTDSbyName(UARTname,(list_head*)&UARThead); //searching UART by name
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
     if(uart==NULL) retVal=NAMEERR; //if not found, return error
-    else if(uart->TXfreehead == NULL) retVal=FULLBUFF; //if buffer full, return error
+    else if(RINGNEXT(uart->TXhead,eng->TXbuffLen) == TXtailAPI(uart)) retVal=FULLBUFF; //if buffer full, return error
     else{ //otherwise add message to queue
-        list_e* tmp=removeHead(&(uart->TXfreehead)); //getting a message from TX free list
-
-        message* msgp=GETMSGP(tmp->data); //getting message pointer
-
-        msgp->data=msg; //setting message
-        msgp->par=computeParity(msg);
-        msgp->flags=0; //clearing flags
-        if(clearRX) SETFLAG(msgp->flags,CLEARRX_F); //setting the eventual clear RX flag
-        if(blank) SETFLAG(msgp->flags,BLANK_F); //setting the eventual blank flag
-
-        appendTail(&(uart->TXhead),tmp); //attaching message to queue
+        char flags=0;
+        if(clearRX) SETFLAG(flags,CLEARRX_F); //setting the eventual clear RX flag
+        if(blank) SETFLAG(flags,BLANK_F); //setting the eventual blank flag
+        TXRING(eng,handle)[uart->TXhead]=TXMSG(buildFrame(msg,uart->format),flags); //setting message
+#if TIMESTAMPS
+        if(eng->TXstamps!=NULL) TXSTAMPS(eng,handle)[uart->TXhead]=readTicks(eng); //enqueue quantum
+#endif
+
+        MEMBARRIER();
+        uart->TXhead=RINGNEXT(uart->TXhead,eng->TXbuffLen); //attaching message to queue
+        kickTX(eng,uart); //notifying ISR that TX ring is not empty
+        WAKEISR(eng);
+        STATHIGH(uart->stats.TXhigh,RINGFILL(uart->TXhead,TXtailAPI(uart),eng->TXbuffLen));
 
     }
 
-    enableInt();
-
     return retVal;
 
 }
 
-int SWUARTreceive(char *msg, char UARTname){
+/* this function will read a message of UART handle of engine eng into msg and,
+ * if stamp is not NULL, its START quantum into stamp (see SWUARTengineReceiveWordH())
+ */
+static int receiveWord(SWUARTengine *eng, unsigned short *msg, swtick *stamp, int handle){
     int retVal=0;
-    if(initCalled == 0){ //if swuart not initialized
+    if(eng->initCalled == 0){ //if swuart not initialized
         return NOINIT;
     }
 
-    disableInt();
-
-    UARTDS *uart=searchUARTDSbyName(UARTname,(list_head*)&UARThead); //searching UART by name
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
     if(uart==NULL) retVal=NAMEERR; //if not found, return error
-    else if(uart->RXhead == NULL) retVal=EMPTYBUFF; //if RX buffer empty
     else{
-        list_e* tmp=removeHead(&(uart->RXhead)); //removing message from RX list head
-
-        message* msgp=GETMSGP(tmp->data); //getting message pointer
+        applyRXflush(uart); //applying ISR clears
+        if(uart->RXtail == uart->RXhead) retVal=EMPTYBUFF; //if RX buffer empty
+        else{
+            message m=RXRING(eng,handle)[uart->RXtail]; //getting message
+
+            *msg=RXMSGDATA(m); //reading message
+#if TIMESTAMPS
+            if(stamp!=NULL) *stamp=(eng->RXstamps!=NULL)?RXSTAMPS(eng,handle)[uart->RXtail]:0; //reading stamp
+#else
+            (void)stamp; //no stamps
+#endif
+
+            if(GETFLAG(m,RXMSGFLAGS+STOPERR_F))retVal=STOPERR; //if stop violation
+            else if(GETFLAG(m,RXMSGFLAGS+PARERR_F)) retVal=PARERR; //if parity bit wrong
+
+            MEMBARRIER();
+            uart->RXtail=RINGNEXT(uart->RXtail,eng->RXbuffLen); //freeing ring slot
+        }
+    }
 
-        *msg=msgp->data; //reading message
+    return retVal;
+}
 
-        if(GETFLAG(msgp->flags,STOPERR_F))retVal=STOPERR; //if stop violation
-        else if(computeParity(*msg) != msgp->par) retVal=PARERR; //if parity bit wrong
+int SWUARTengineReceiveWordH(SWUARTengine *eng, unsigned short *msg, int handle){
+    return receiveWord(eng,msg,NULL,handle);
+}
 
-        appendTail(&(uart->RXfreehead),tmp); //putting message on free list
+#if TIMESTAMPS
+int SWUARTengineReceiveWordStampedH(SWUARTengine *eng, unsigned short *msg, swtick *stamp, int handle){
+    return receiveWord(eng,msg,stamp,handle);
+}
+#endif
 
+int SWUARTengineSendBufferH(SWUARTengine *eng, const char *msgs, int len, int handle){
+    int retVal=0;
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return -NOINIT;
     }
 
-    enableInt();
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) retVal=-NAMEERR; //if not found, return error
+    else{ //otherwise add messages to queue
+        txmessage *ring=TXRING(eng,handle);
+        unsigned char head=uart->TXhead;
+        unsigned char tail=TXtailAPI(uart);
+#if TIMESTAMPS
+        swtick now=readTicks(eng); //enqueue quantum of all the messages
+#endif
+
+        while(retVal<len && RINGNEXT(head,eng->TXbuffLen)!=tail){ //until all sent or buffer full
+            ring[head]=TXMSG(buildFrame((unsigned char)msgs[retVal],uart->format),0); //setting message
+#if TIMESTAMPS
+            if(eng->TXstamps!=NULL) TXSTAMPS(eng,handle)[head]=now;
+#endif
+
+            head=RINGNEXT(head,eng->TXbuffLen);
+            retVal++;
+        }
+
+        if(retVal){
+            MEMBARRIER();
+            uart->TXhead=head; //attaching all the messages to queue
+            kickTX(eng,uart); //notifying ISR that TX ring is not empty
+            WAKEISR(eng);
+            STATHIGH(uart->stats.TXhigh,RINGFILL(head,TXtailAPI(uart),eng->TXbuffLen));
+        }
+    }
 
     return retVal;
 }
 
-int SWUARTreceive_blocking(char *msg, char UARTname){
-    int retVal=SWUARTreceive(msg,UARTname);
-    while(retVal == EMPTYBUFF){    //looping if RX buffer empty
-        retVal=SWUARTreceive(msg,UARTname);
+int SWUARTengineReceiveBufferH(SWUARTengine *eng, char *msgs, int len, int handle, char *status){
+    int retVal=0;
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return -NOINIT;
+    }
+
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) retVal=-NAMEERR; //if not found, return error
+    else{
+        applyRXflush(uart); //applying ISR clears
+        message *ring=RXRING(eng,handle);
+        unsigned char tail=uart->RXtail;
+        unsigned char head=uart->RXhead;
+
+        while(retVal<len && tail!=head){ //until all read or buffer empty
+            message m=ring[tail]; //getting message
+
+            msgs[retVal]=(char)RXMSGDATA(m); //reading message
+
+            if(status!=NULL){
+                if(GETFLAG(m,RXMSGFLAGS+STOPERR_F)) status[retVal]=STOPERR; //if stop violation
+                else if(GETFLAG(m,RXMSGFLAGS+PARERR_F)) status[retVal]=PARERR; //if parity bit wrong
+                else status[retVal]=0;
+            }
+
+            tail=RINGNEXT(tail,eng->RXbuffLen);
+            retVal++;
+        }
+
+        if(retVal){
+            MEMBARRIER();
+            uart->RXtail=tail; //freeing all the read ring slots
+        }
     }
+
     return retVal;
 }
 
-int SWUARTclearBuffer(char TXn_RX, char UARTname){
+int SWUARTengineClearBufferH(SWUARTengine *eng, char TXn_RX, int handle){
     int retVal=0;
-    if(initCalled == 0){ //if swuart not initialized
+    if(eng->initCalled == 0){ //if swuart not initialized
         return NOINIT;
     }
 
-    disableInt();
-
-    UARTDS *uart=searchUARTDSbyName(UARTname,(list_head*)&UARThead); //searching UART by name
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
     if(uart==NULL) retVal=NAMEERR; //if not found, return error
     else{ //otherwise clear the buffer
         if(!TXn_RX){ //TX buffer
-            mergeList(&(uart->TXhead),&(uart->TXfreehead)); //moving all the elements of list to free list
-
+            uart->TXclrIdx=uart->TXhead; //requesting ISR to empty the ring up to current write index
+            uart->TXclrReq++;
         }else{ //RX buffer
-            mergeList(&(uart->RXhead),&(uart->RXfreehead)); //moving all the elements of list to free list
-            SETFLAG(uart->currRX.flags,CLEARRX_F); //setting currently RX message to not be saved
+            applyRXflush(uart); //applying ISR clears
+            uart->RXtail=uart->RXhead; //emptying ring
+            uart->RXclrReq++; //setting currently RX message to not be saved
         }
     }
 
-    enableInt();
     return retVal;
 }
 
-void SWUART_isr(){
-    if(UARThead==NULL) return; //return if no active UARTs
+int SWUARTengineSetBaudH(SWUARTengine *eng, unsigned short bitLen, int handle){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return NOINIT;
+    }
 
-    list_e *tmp=UARThead;
-    UARTDS * uptr;
-    //RX loop
-    do{
-        uptr=GETUDSP(tmp->data);//getting the UART pointer
-        if(GETFLAG(uptr->RXflags,ENABLE_F)){ //if UART RX is enabled
-            //incrementing quantum
-            uptr->RXquantum++;
-
-            char smp=readPin(uptr->RXpin); //reading RX pin
-
-            if(uptr->RXbit!=0){ //IF NOT IDLE
-                if(uptr->RXquantum == BITQUANTI){ //if bit window over
-                    uptr->RXbit++; //incrementing bit
-                    uptr->RXquantum=0; //resetting quantum
-
-                    if(uptr->RXbit == 12){ //if STOP
-                        //saving message
-                        if(!GETFLAG(uptr->currRX.flags,CLEARRX_F)){ //if not clearRX
-                            if(uptr->RXfreehead != NULL){//if RX buffer not full
-                                list_e *tmp=removeHead(&(uptr->RXfreehead)); //taking element from free list
-                                message *msg=GETMSGP(tmp->data); //getting message pointer
-    
-                                msg->data=uptr->currRX.data; //setting data
-                                msg->par=uptr->currRX.par; //setting parity
-                                msg->flags=uptr->currRX.flags; //setting flags
-    
-                                appendTail(&(uptr->RXhead),tmp); //putting element into list
-                            }
-                        }else{
-                            mergeList(&(uptr->RXhead),&(uptr->RXfreehead)); //moving all the elements of list to free list
-                        }
-    
-                        uptr->RXbit=0; //return to IDLE
-                    }
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) return NAMEERR; //if not found, return error
 
-                }
+    if(bitLen<MINBITLEN || bitLen>MAXBITLEN) return BAUDERR; //if out of range
+#if BITSLICED
+    if(bitLen!=eng->defBitLen) return BAUDERR; //the bit-sliced engine has a single bit timing
+#endif
 
-                if(uptr->RXquantum == SMPQUANTUM){ //if it's time to sample
-                    switch (uptr->RXbit){
-                        case 1:{ //START
-                            if(smp != 0){ //START violation
-                                uptr->RXbit=0; //setting bit as IDLE
-                            }
-                            break;
-                        }
-                        case 10:{ //PARITY
-                            uptr->currRX.par=smp;
-                            break;
-                        }
-                        case 11:{ //STOP
-                            if(smp != 1){ //STOP violation
-                                SETFLAG(uptr->currRX.flags,STOPERR_F); //setting stop error flag
-                            }
-                            break;
-                        }
-                        default:{ //DATA BITS
-                            if(smp) //if 1
-                                SETFLAG(uptr->currRX.data,uptr->RXbit-2);
-                            else
-                                RESETFLAG(uptr->currRX.data,uptr->RXbit-2);
-
-                            break;
-                        }
-                    }
-                }
-            }
+    disableInt();
 
-            if(uptr->RXbit==0){ //IF IDLE
-                if(uptr->oldVal == 1 && smp==0){ //if START CONDITION
-                        uptr->RXbit=1; //setting bit as start
-                        uptr->RXquantum=0; //resetting quantum
+    eng->TXstate[handle].bitLen=bitLen;
+    if(GETFLAG(uart->RXflags,ENABLE_F)){ //moving RX to the line of the new bit length (if not TX only)
+        detachRXline(eng,uart);
+        attachRXline(eng,uart);
+    }
 
-                        uptr->currRX.flags=0; //resetting current RX message flags
-                }
-            }
+    enableInt();
 
-            //updating oldVal
-            uptr->oldVal=smp;
-        }
+    return 0;
+}
 
-        tmp=tmp->next; //going to next UART
-    }while(tmp!=UARThead);
+int SWUARTengineSetFormatH(SWUARTengine *eng, char format, int handle){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return NOINIT;
+    }
 
-    //TX loop
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) return NAMEERR; //if not found, return error
 
-    tmp=UARThead;
-    do{
-        uptr=GETUDSP(tmp->data);//getting the UART pointer
-        if(GETFLAG(uptr->TXflags,ENABLE_F)){ //if UART TX is enabled
-            char outVal=-1; //value to be written as output
+    if(FMTBITS(format)>9 || FMTPAR(format)>PARODD || (format & 0xC0)) return FORMATERR; //if not a valid format
 
-            //incrementing quantum
-            uptr->TXquantum++;
+    disableInt();
 
-            if(uptr->TXbit!=0){ //IF NOT IDLE
-                if(uptr->TXquantum == BITQUANTI){ //if it's time to change output
-                    //changing to next bit
-                    uptr->TXbit++; //incrementing bit
-                    uptr->TXquantum=0; //resetting quantum
+    uart->format=format;
+    if(GETFLAG(uart->RXflags,ENABLE_F)){ //moving RX to the line of the new format (if not TX only)
+        detachRXline(eng,uart);
+        attachRXline(eng,uart);
+    }
 
-                    if(uptr->TXbit==12){ //if stop over
-                        uptr->TXbit=0; //return to IDLE
-                    }
+    enableInt();
 
-                    switch (uptr->TXbit){
-
-                        case 10:{ //PARITY
-                            outVal=uptr->currTX.par;
-                            break;
-                        }
-                        case 11:{ //STOP
-                            outVal=1;
-                            break;
-                        }
-                        default:{ //DATA BITS
-                            outVal=GETFLAG(uptr->currTX.data,uptr->TXbit-2);
-
-                            break;
-                        }
-                    }
-                }
+    return 0;
+}
 
+#if PACKETRX
+int SWUARTengineSetPacketH(SWUARTengine *eng, int delim, unsigned short gap, int handle){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return NOINIT;
+    }
 
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) return NAMEERR; //if not found, return error
 
-            }
+    if(delim<NODELIM || delim>0x1FF) return FORMATERR; //if not a 9 bit word
 
-            if(uptr->TXbit==0){ //IF IDLE
-                if(uptr->TXhead!=NULL){ //if some message to send
-                        list_e *tmp=removeHead(&(uptr->TXhead)); //taking element from list
-                        message *msg=GETMSGP(tmp->data); //getting message pointer
-
-                        uptr->TXbit=1; //setting bit as start
-                        uptr->TXquantum=0; //resetting quantum
-                        outVal=0; //setting output as 0
-
-                        //copying message into currently TX message
-                        uptr->currTX.data=msg->data;
-                        uptr->currTX.par=msg->par;
-                        uptr->currTX.flags=msg->flags;
-
-                        appendTail(&(uptr->TXfreehead),tmp); //putting element into free list
-
-                        //if CLEARRX_F, clearing RX buffer
-                        if(GETFLAG(uptr->currTX.flags,CLEARRX_F)){
-                            SETFLAG(uptr->currRX.flags,CLEARRX_F); //setting current RX message to clear
-                            mergeList(&(uptr->RXhead),&(uptr->RXfreehead)); //moving all the elements of RX list to free list
-                        }
-                }else{
-                    outVal=1;
-                }
-            }
-            //writing output
-            if(outVal!=-1 && !GETFLAG(uptr->currTX.flags,BLANK_F)) writePin(uptr->TXpin,outVal); //if out value has been changed
-        }
-        tmp=tmp->next; //going to next UART
-    }while(tmp!=UARThead);
-}
\ No newline at end of file
+    disableInt();
+
+    uart->pktDelim=(delim==NODELIM)?NOPKTDELIM:(unsigned short)delim;
+    uart->pktGap=gap;
+    if(uart->pktOpen) closePacket(eng,handle); //the messages received with the old settings are a packet
+
+    enableInt();
+
+    return 0;
+}
+
+int SWUARTengineReceivePacketH(SWUARTengine *eng, char *msgs, int len, int handle, char *status){
+    int retVal=0;
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return -NOINIT;
+    }
+
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) return -NAMEERR; //if not found, return error
+
+    applyRXflush(uart); //applying ISR clears
+    message *ring=RXRING(eng,handle);
+    unsigned char tail=uart->RXtail;
+    unsigned char head=uart->RXhead;
+
+    //searching the last message of the first packet
+    unsigned char end=tail;
+    while(end!=head && !GETFLAG(ring[end],RXMSGFLAGS+PKTEND_F)) end=RINGNEXT(end,eng->RXbuffLen);
+    if(end==head) return -EMPTYBUFF; //if no complete packet
+    end=RINGNEXT(end,eng->RXbuffLen);
+
+    char cut=0, stopErr=0, parErr=0; //packet status
+    while(tail!=end){ //reading the packet
+        message m=ring[tail]; //getting message
+
+        if(retVal<len) msgs[retVal++]=(char)RXMSGDATA(m); //reading message
+        else cut=1; //dropping the messages over len
+
+        if(GETFLAG(m,RXMSGFLAGS+PKTCUT_F)) cut=1;
+        if(GETFLAG(m,RXMSGFLAGS+STOPERR_F)) stopErr=1;
+        if(GETFLAG(m,RXMSGFLAGS+PARERR_F)) parErr=1;
+
+        tail=RINGNEXT(tail,eng->RXbuffLen);
+    }
+
+    MEMBARRIER();
+    uart->RXtail=tail; //freeing all the packet ring slots
+
+    if(status!=NULL){
+        if(cut) *status=FULLBUFF;
+        else if(stopErr) *status=STOPERR;
+        else if(parErr) *status=PARERR;
+        else *status=0;
+    }
+
+    return retVal;
+}
+#endif
+
+int SWUARTengineSendWordTimeoutH(SWUARTengine *eng, unsigned short msg, int handle, char clearRX, char blank, unsigned long timeout){
+    unsigned long waited=0; //quanti waited
+    while(1){
+        unsigned char seq=eng->tickSeq; //(read before trying, so a slot freed meanwhile is not missed)
+        int retVal=SWUARTengineSendWordH(eng,msg,handle,clearRX,blank);
+        if(retVal!=FULLBUFF) return retVal; //if sent or error
+        if(timeout!=FOREVER && waited>=timeout) return TIMEOUT;
+        waited+=waitISR(eng,seq); //waiting next isr call
+    }
+}
+
+int SWUARTengineReceiveWordTimeoutH(SWUARTengine *eng, unsigned short *msg, int handle, unsigned long timeout){
+    unsigned long waited=0; //quanti waited
+    while(1){
+        unsigned char seq=eng->tickSeq; //(read before trying, so a message received meanwhile is not missed)
+        int retVal=SWUARTengineReceiveWordH(eng,msg,handle);
+        if(retVal!=EMPTYBUFF) return retVal; //if read or error
+        if(timeout!=FOREVER && waited>=timeout) return TIMEOUT;
+        waited+=waitISR(eng,seq); //waiting next isr call
+    }
+}
+
+#if UARTSTATS
+int SWUARTengineGetStatsH(SWUARTengine *eng, SWUARTstats *stats, int handle, char reset){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return NOINIT;
+    }
+
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) return NAMEERR; //if not found, return error
+
+    disableInt();
+    *stats=uart->stats; //snapshot
+    if(reset){
+        SWUARTstats zero={0,0,0,0,0,0,0,0};
+        uart->stats=zero;
+    }
+    enableInt();
+
+    return 0;
+}
+#endif
+
+#if TIMESTAMPS
+void SWUARTengineSetStamps(SWUARTengine *eng, swtick *RXstamps, swtick *TXstamps){
+    eng->RXstamps=RXstamps;
+    eng->TXstamps=TXstamps;
+}
+
+swtick SWUARTengineGetTicks(SWUARTengine *eng){
+    return readTicks(eng);
+}
+
+int SWUARTengineGetTXStampsH(SWUARTengine *eng, swtick *enqueued, swtick *started, int handle){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return NOINIT;
+    }
+
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) return NAMEERR; //if not found, return error
+
+    disableInt(); //both stamps of the same message
+    *enqueued=uart->TXenqueued;
+    *started=uart->TXstarted;
+    enableInt();
+
+    return 0;
+}
+#endif
+
+#if UARTEVENTS
+int SWUARTengineSetCallbackH(SWUARTengine *eng, SWUARTcallback callback, char events, char mode, int handle){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return NOINIT;
+    }
+
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) return NAMEERR; //if not found, return error
+
+    if(callback==NULL) events=0; //no callback, no events
+    disableInt(); //callback, mask and mode read together by the ISR
+    uart->callback=callback;
+    uart->evMask=events & EVALL;
+    uart->evMode=mode;
+    uart->evAck=uart->evPend; //dropping the events not yet dispatched
+    enableInt();
+
+    return 0;
+}
+
+int SWUARTengineDispatch(SWUARTengine *eng){
+    if(eng->initCalled == 0) return 0; //if swuart not initialized
+    int calls=0;
+
+    //UARTs queued by the ISR
+    while(eng->evTail!=eng->evHead){
+        slotidx u=eng->evQueue[eng->evTail]; //getting UART
+        MEMBARRIER();
+        eng->evTail=RINGNEXT(eng->evTail,EVQUEUELEN); //freeing queue slot
+        calls+=dispatchUART(eng,u);
+    }
+
+    //UARTs that didn't fit into the queue
+    if(eng->evOverflow){
+        eng->evOverflow=0; //cleared before the scan, a new overflow will be seen by the next call
+        for(int u=0;u<eng->UARTnum;u++){
+            if(eng->UARTbuffer[u].evPend!=eng->UARTbuffer[u].evAck) calls+=dispatchUART(eng,u);
+        }
+    }
+    return calls;
+}
+#endif
+
+#if TXWAVE
+int SWUARTengineSetWaveH(SWUARTengine *eng, char on, int handle){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return NOINIT;
+    }
+
+    UARTDS *uart=getUARTDS(eng,handle); //getting UART
+    if(uart==NULL) return NAMEERR; //if not found, return error
+
+    UARTtx *tx=&eng->TXstate[handle];
+    int w=handle/SLICEBITS;
+    sliceword bm=SLICEBIT(handle);
+    on=(on!=0);
+    if(((eng->TXwave[w] & bm)!=0)==on) return 0; //if already in the mode
+    if(on && (tx->port==NOPORT || (eng->waveMask && tx->port!=eng->wavePort))) return PINERR; //if not on the wave port
+
+    disableInt();
+
+    char start=(eng->waveMask==0); //flag set if the ring has to be started
+    tx->frame=0; //cutting the frame being sent
+    outputPin(eng,handle,1); //line HIGH
+    if(on){ //moving the TX from the ISR to render
+        eng->TXen[w]&=~bm;
+#if BITSLICED
+        eng->TXbusy[w]&=~bm;
+        eng->TXpend[w]&=~bm;
+#else
+        eng->TXact[w]&=~bm;
+#endif
+        eng->TXwave[w]|=bm;
+        if(start){ //ring found empty, so render starts after the next slot
+            eng->wavePort=tx->port;
+            eng->waveWord=0;
+            eng->waveLast=0;
+            for(int i=0;i<WAVELEN;i++) eng->waveBuf[i]=0;
+            eng->waveIn=0;
+            eng->waveOut=0;
+            eng->waveDry=1;
+            eng->waveDryIn=0;
+            eng->waveBusy=0;
+        }
+        //line HIGH inside the ring
+        eng->waveMask|=tx->mask;
+        eng->waveWord|=tx->mask;
+        eng->waveLast|=tx->mask;
+        for(int i=0;i<WAVELEN;i++) eng->waveBuf[i]|=tx->mask;
+    }else{ //moving the TX from render to the ISR
+        eng->TXwave[w]&=~bm;
+        eng->waveMask&=~tx->mask;
+        eng->TXen[w]|=bm;
+        kickTX(eng,uart); //(messages still inside the TX ring)
+    }
+#if PORTIO
+    if(on && start) eng->waveDMA=!startWaveDMA(eng->portID[eng->wavePort],eng->waveMask,eng->waveBuf,WAVELEN);
+    else if(eng->waveDMA) startWaveDMA(eng->portID[eng->wavePort],eng->waveMask,eng->waveBuf,WAVELEN); //new mask (0 stops it)
+    if(eng->waveMask==0) eng->waveDMA=0;
+#endif
+
+    enableInt();
+
+    return 0;
+}
+
+int SWUARTengineRender(SWUARTengine *eng){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return -NOINIT;
+    }
+    if(eng->waveMask==0) return 0; //if no wave UARTs
+
+    int W=eng->words;
+    char busy=0; //flag set if some wave UART has frames to render
+    for(int w=0;w<W && !busy;w++){
+        for(sliceword m=eng->TXwave[w];m && !busy;m&=m-1){
+            int u=w*SLICEBITS+sliceCtz(m);
+            UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u];
+            busy=(eng->TXstate[u].frame!=0 || TXtailAPI(uptr)!=uptr->TXhead);
+        }
+    }
+    eng->waveBusy=busy;
+    if(!busy) return 0;
+
+    unsigned char out=eng->waveOut;
+    unsigned char in=eng->waveIn;
+    if(eng->waveDry && eng->waveDryIn==in){ //if the ISR found the ring empty, restarting it after the next slot
+        eng->waveBuf[(unsigned char)(out+1)%WAVELEN]=eng->waveWord; //(the ISR may be holding the same word there)
+        in=(unsigned char)(out+2);
+    }
+
+    int n=0;
+    while(busy && (unsigned char)(in-out)<WAVELEN){ //rendering up to the slot before the one being output
+        portword word=eng->waveWord;
+        busy=0;
+        for(int w=0;w<W;w++){
+            for(sliceword m=eng->TXwave[w];m;m&=m-1){
+                int u=w*SLICEBITS+sliceCtz(m);
+                UARTtx *tx=&eng->TXstate[u];
+                char outVal=stepTX(eng,u,1); //same TX state machine of the ISR
+
+                if(outVal==TXIDLE) outVal=1; //line HIGH
+                else busy=1;
+                if(outVal!=-1 && !GETFLAG(tx->flags,BLANK_F)){
+                    if(outVal) word|=tx->mask;
+                    else word&=~tx->mask;
+                }
+            }
+        }
+        eng->waveWord=word;
+        eng->waveBuf[in%WAVELEN]=word;
+        MEMBARRIER();
+        in++;
+        eng->waveIn=in; //publishing slot
+        n++;
+    }
+    eng->waveBusy=busy;
+
+    return n;
+}
+
+unsigned char SWUARTengineGetWaveUnderruns(SWUARTengine *eng){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return 0;
+    }
+    unsigned char under=eng->waveUnder;
+    unsigned char n=(unsigned char)(under-eng->waveUnderAck);
+    eng->waveUnderAck=under;
+    return n;
+}
+#endif
+
+#if BITSLICED
+void SWUARTengine_isr(SWUARTengine *eng){
+#if TICKLESS
+    unsigned char step=eng->tickStep; //quanti since the previous call
+#else
+    const unsigned char step=1;
+#endif
+    eng->tickSeq+=step; //counting the quanti (waited by the blocking functions)
+#if TIMESTAMPS
+    eng->ticks+=step; //quantum of this call
+#endif
+    if(eng->UARTnum==0) return; //return if no active UARTs
+    PROFTIME(t0);
+#if STAGEDTX
+    writeOutputs(eng); //writing the TX levels staged by the previous call, at a fixed time from the ISR entry
+#endif
+
+#if PORTIO
+    //sampling all the ports with RX pins
+    for(unsigned char p=0;p<eng->portNum;p++){
+        if(eng->portRead[p]) eng->portIn[p]=readPort(eng->portID[p]);
+    }
+#endif
+
+    int W=eng->words; //number of words of each mask (planes are W words apart)
+#if TICKLESS
+    unsigned char slicePhase=(unsigned char)((eng->slicePhase+step-1)%eng->bitQuanti); //(skipped quanti had no work)
+    eng->slicePhase=slicePhase; //(read by sliceSlot())
+#else
+    unsigned char slicePhase=eng->slicePhase;
+#endif
+    unsigned char smpPhase=(slicePhase+eng->bitQuanti-eng->smpQuantum)%eng->bitQuanti; //phase slot of the UARTs at smpQuantum
+
+    sliceword *RXen=eng->RXen;
+    sliceword *RXbusy=eng->RXbusy;
+    sliceword *RXsh=eng->RXsh;
+
+    //RX words loop
+    for(int w=0;w<W;w++){
+        if(!RXen[w]) continue; //if no enabled lines inside the word
+
+#if EDGERX
+        sliceword wake=eng->RXwake[w] ^ eng->RXwakeAck[w]; //lines woken by START edge
+        eng->RXwakeAck[w]^=wake;
+        eng->RXsleep[w]&=~wake;
+#endif
+
+        //sampling RX pins (sleeping lines are idle)
+        sliceword smp=eng->RXsleep[w];
+        sliceword m=RXen[w] & ~eng->RXsleep[w];
+        while(m){
+            int b=sliceCtz(m);
+            m&=m-1;
+            if(samplePin(eng,&eng->lineBuffer[w*SLICEBITS+b])) smp|=((sliceword)1)<<b;
+        }
+
+        sliceword bnd=RXbusy[w] & eng->RXslot[slicePhase*W+w]; //lines with bit window over
+        if(bnd){
+            sliceInc(eng->RXcnt+w,W,bnd); //incrementing bit
+            sliceword done=bnd & sliceEqv(eng->RXcnt+w,eng->RXend+w,W); //lines at the end of STOP
+            RXbusy[w]&=~done; //return to IDLE
+
+            while(done){ //saving the messages
+                int b=sliceCtz(done);
+                done&=done-1;
+                RXline *line=&eng->lineBuffer[w*SLICEBITS+b];
+
+                unsigned short frame=0; //rebuilding the frame word (START is 0)
+                int k=line->RXlen-1; //number of bits shifted in after START
+                for(int i=0;i<k;i++){
+                    if(GETFLAG(RXsh[(SHPLANES-k+i)*W+w],b)) SETFLAG(frame,FRAME_DATA+i);
+                }
+
+                deliverRX(eng,line,frame);
+            }
+        }
+
+        sliceword smpm=RXbusy[w] & eng->RXslot[smpPhase*W+w]; //lines to be sampled
+        if(smpm){
+            sliceword st=smpm & sliceEq(eng->RXcnt+w,W,1); //lines sampling START
+            RXbusy[w]&=~(st & smp); //START violation, setting bit as IDLE
+#if UARTSTATS
+            for(sliceword fs=st & smp;fs;fs&=fs-1) falseStartRX(eng,&eng->lineBuffer[w*SLICEBITS+sliceCtz(fs)]);
+#endif
+
+            sliceword dm=smpm & ~st; //lines sampling DATA/PARITY/STOP, shifting sample into register
+            for(int i=0;i<SHPLANES-1;i++){
+                RXsh[i*W+w]=(RXsh[i*W+w] & ~dm) | (RXsh[(i+1)*W+w] & dm);
+            }
+            RXsh[(SHPLANES-1)*W+w]=(RXsh[(SHPLANES-1)*W+w] & ~dm) | (smp & dm);
+        }
+
+        sliceword start=RXen[w] & ~RXbusy[w] & eng->RXold[w] & ~smp; //lines with START CONDITION
+        if(start){
+            RXbusy[w]|=start;
+            sliceSet(eng->RXcnt+w,W,start,1); //setting bit as start
+            sliceSlot(eng,eng->RXslot+w,start); //resetting quantum
+
+            while(start){ //resetting current RX message flags
+                int b=sliceCtz(start);
+                start&=start-1;
+                startRX(eng,&eng->lineBuffer[w*SLICEBITS+b]);
+            }
+        }
+
+        //updating oldVal
+        eng->RXold[w]=(eng->RXold[w] & ~RXen[w]) | (smp & RXen[w]);
+
+#if EDGERX
+        sliceword slp=eng->RXedge[w] & ~eng->RXsleep[w] & ~RXbusy[w] & smp; //idle lines, sleeping until START edge
+        while(slp){
+            int b=sliceCtz(slp);
+            slp&=slp-1;
+            sleepRX(eng,&eng->lineBuffer[w*SLICEBITS+b],w*SLICEBITS+b);
+        }
+#endif
+    }
+
+#if PACKETRX
+    //counting the idle gaps of the lines with open packets
+    for(int w=0;w<W;w++){
+        sliceword g=eng->RXgap[w] & ~RXbusy[w];
+        while(g){
+            int b=sliceCtz(g);
+            g&=g-1;
+            gapRX(eng,w*SLICEBITS+b);
+        }
+    }
+#endif
+
+    PROFTIME(t1);
+
+    sliceword *TXbusy=eng->TXbusy;
+    sliceword *TXpend=eng->TXpend;
+    sliceword *TXsh=eng->TXsh;
+
+    //TX words loop
+    for(int w=0;w<W;w++){
+        sliceword kick=eng->TXkick[w] ^ eng->TXkickAck[w]; //UARTs kicked by API
+        eng->TXkickAck[w]^=kick;
+        TXpend[w]|=kick & eng->TXen[w];
+
+        if(!(TXbusy[w] | TXpend[w])) continue; //if all the UARTs inside the word are idle
+
+        sliceword out=0; //values to be written as output
+        sliceword wr=0; //UARTs whose output has to be written
+        sliceword done=0; //UARTs returning to IDLE
+
+        sliceword bnd=TXbusy[w] & eng->TXslot[slicePhase*W+w]; //UARTs changing output
+        if(bnd){
+            sliceInc(eng->TXcnt+w,W,bnd); //incrementing bit
+            done=bnd & sliceEqv(eng->TXcnt+w,eng->TXend+w,W); //if stop over, return to IDLE
+            TXbusy[w]&=~done;
+
+            sliceword sh=bnd & TXbusy[w]; //UARTs sending next bit
+            out=TXsh[w] & sh;
+            wr=sh;
+            for(int i=0;i<SHPLANES-1;i++){ //shifting register
+                TXsh[i*W+w]=(TXsh[i*W+w] & ~sh) | (TXsh[(i+1)*W+w] & sh);
+            }
+        }
+
+        sliceword start=eng->TXen[w] & ~TXbusy[w] & TXpend[w]; //idle UARTs with some message to send
+        wr|=start | done;
+        out|=done & ~start; //idle line, written only once as the UART returns to IDLE
+#if UARTEVENTS
+        for(sliceword dr=done & ~start;dr;dr&=dr-1) EVENT(eng,w*SLICEBITS+sliceCtz(dr),EVTXDONE,0); //TX buffers drained
+#endif
+
+        while(start){
+            int b=sliceCtz(start);
+            start&=start-1;
+            int u=w*SLICEBITS+b;
+            UARTDS *uptr=(UARTDS*)&eng->UARTbuffer[u];
+            UARTtx *tx=&eng->TXstate[u];
+            sliceword bm=((sliceword)1)<<b;
+
+            if(!startTX(eng,u)){ //if TX ring empty
+                TXpend[w]&=~bm;
+                out|=bm;
+                EVENT(eng,u,EVTXDONE,0);
+                continue;
+            }
+            if(uptr->TXtail==uptr->TXhead) TXpend[w]&=~bm; //if it was the last message
+
+            //loading the frame into the register (bits after START)
+            for(int i=0;i<SHPLANES;i++){
+                if(GETFLAG(tx->frame,FRAME_DATA+i)) TXsh[i*W+w]|=bm;
+                else TXsh[i*W+w]&=~bm;
+            }
+            char len=0; //number of frame bits (position of the end marker)
+            for(unsigned short f=tx->frame;f>1;f>>=1) len++;
+            sliceSet(eng->TXend+w,W,bm,len+1);
+
+            if(GETFLAG(tx->flags,BLANK_F)) eng->TXblank[w]|=bm;
+            else eng->TXblank[w]&=~bm;
+
+            TXbusy[w]|=bm;
+            sliceSet(eng->TXcnt+w,W,bm,1); //setting bit as start
+            sliceSlot(eng,eng->TXslot+w,bm); //resetting quantum
+        }
+
+        //writing outputs
+        wr&=~eng->TXblank[w];
+        while(wr){
+            int b=sliceCtz(wr);
+            wr&=wr-1;
+            outputPin(eng,w*SLICEBITS+b,GETFLAG(out,b));
+        }
+    }
+
+#if TXWAVE
+    if(eng->waveMask) waveTick(eng); //outputting the rendered TX waveform
+#endif
+
+#if !STAGEDTX
+    writeOutputs(eng); //writing the TX pins changed by this call
+#endif
+
+    slicePhase++; //next quantum
+    if(slicePhase==eng->bitQuanti) slicePhase=0;
+    eng->slicePhase=slicePhase;
+
+#if TICKLESS
+    if(eng->tickless) eng->tickStep=setNextTick(nextTick(eng)); //programming the next call
+#endif
+
+    PROFRECORD(eng,t0,t1);
+}
+#else
+void SWUARTengine_isr(SWUARTengine *eng){
+#if TICKLESS
+    unsigned char step=eng->tickStep; //quanti since the previous call
+#else
+    const unsigned char step=1;
+#endif
+    eng->tickSeq+=step; //counting the quanti (waited by the blocking functions)
+#if TIMESTAMPS
+    eng->ticks+=step; //quantum of this call
+#endif
+    if(eng->UARTnum==0) return; //return if no active UARTs
+    PROFTIME(t0);
+#if STAGEDTX
+    writeOutputs(eng); //writing the TX levels staged by the previous call, at a fixed time from the ISR entry
+#endif
+
+#if PORTIO
+    //sampling all the ports with RX pins
+    for(unsigned char p=0;p<eng->portNum;p++){
+        if(eng->portRead[p]) eng->portIn[p]=readPort(eng->portID[p]);
+    }
+#endif
+
+    int W=eng->words; //number of words of each mask
+
+    //RX lines loop
+    for(int w=0;w<W;w++){
+#if EDGERX
+        sliceword wake=eng->RXwake[w] ^ eng->RXwakeAck[w]; //lines woken by START edge
+        eng->RXwakeAck[w]^=wake;
+        eng->RXsleep[w]&=~wake;
+#endif
+
+        sliceword m=eng->RXen[w] & ~eng->RXsleep[w]; //enabled lines not sleeping
+        while(m){
+            int b=sliceCtz(m);
+            m&=m-1;
+            int l=w*SLICEBITS+b;
+            RXline *lptr=&eng->lineBuffer[l]; //getting the line pointer
+
+            //advancing phase by one quantum
+            lptr->RXphase+=1<<8;
+
+            char smp=samplePin(eng,lptr); //reading RX pin
+
+            if(lptr->RXbit!=0){ //IF NOT IDLE
+                if(lptr->RXphase >= lptr->bitLen){ //if bit window over
+                    lptr->RXbit++; //incrementing bit
+                    lptr->RXphase-=lptr->bitLen; //keeping the fractional part of the phase
+
+                    if(lptr->RXbit == lptr->RXlen+1){ //if STOP
+                        deliverRX(eng,lptr,lptr->RXframe); //saving message into all the UARTs of the line
+                        lptr->RXbit=0; //return to IDLE
+                    }
+
+                }
+
+                if(lptr->RXphase >= lptr->smpPhase && lptr->RXphase < lptr->smpPhase+(1<<8)){ //if it's time to sample
+                    if(lptr->RXbit==1 && smp!=0){ //START violation
+                        lptr->RXbit=0; //setting bit as IDLE
+#if UARTSTATS
+                        falseStartRX(eng,lptr);
+#endif
+                    }else{ //shifting sample into frame
+                        lptr->RXframe=(lptr->RXframe>>1) | ((unsigned short)smp<<(lptr->RXlen-1));
+                    }
+                }
+            }
+
+            if(lptr->RXbit==0){ //IF IDLE
+                if(lptr->oldVal == 1 && smp==0){ //if START CONDITION
+                        lptr->RXbit=1; //setting bit as start
+                        lptr->RXphase=0; //resetting phase
+
+                        startRX(eng,lptr); //resetting current RX message flags
+                }
+            }
+
+            //updating oldVal
+            lptr->oldVal=smp;
+
+#if EDGERX
+            if(lptr->RXbit==0 && smp && (eng->RXedge[w] & (((sliceword)1)<<b))) sleepRX(eng,lptr,l); //if idle, sleeping until START edge
+#endif
+        }
+    }
+
+#if PACKETRX
+    //counting the idle gaps of the lines with open packets
+    for(int w=0;w<W;w++){
+        sliceword g=eng->RXgap[w];
+        while(g){
+            int b=sliceCtz(g);
+            g&=g-1;
+            if(eng->lineBuffer[w*SLICEBITS+b].RXbit==0) gapRX(eng,w*SLICEBITS+b);
+        }
+    }
+#endif
+
+    PROFTIME(t1);
+
+    //TX loop
+    for(int w=0;w<W;w++){
+        sliceword kick=eng->TXkick[w] ^ eng->TXkickAck[w]; //UARTs kicked by API
+        eng->TXkickAck[w]^=kick;
+        eng->TXact[w]|=kick & eng->TXen[w];
+
+        sliceword m=eng->TXact[w]; //UARTs not idle or with some message to send
+        while(m){
+            int b=sliceCtz(m);
+            m&=m-1;
+            int u=w*SLICEBITS+b;
+            char outVal=stepTX(eng,u,step); //value to be written as output
+
+            if(outVal==TXIDLE){ //if no message to send
+                outVal=1; //line HIGH, written only once as the UART leaves the active mask
+                eng->TXact[w]&=~(((sliceword)1)<<b);
+                EVENT(eng,u,EVTXDONE,0);
+            }
+            //writing output
+            if(outVal!=-1 && !GETFLAG(eng->TXstate[u].flags,BLANK_F)) outputPin(eng,u,outVal); //if out value has been changed
+        }
+    }
+
+#if TXWAVE
+    if(eng->waveMask) waveTick(eng); //outputting the rendered TX waveform
+#endif
+
+#if !STAGEDTX
+    writeOutputs(eng); //writing the TX pins changed by this call
+#endif
+
+#if TICKLESS
+    if(eng->tickless) eng->tickStep=setNextTick(nextTick(eng)); //programming the next call
+#endif
+
+    PROFRECORD(eng,t0,t1);
+}
+#endif
+
+// ---------- VIRTUAL TIME ----------
+
+/* this function will check if engine eng is idle: no frame being sent or received, no pending kick of the API
+ * or wake of the edge callback and every awake RX line already sampled the current value of its pin, so until
+ * a pin changes or the API is called each isr call would only advance the quantum counters
+ */
+static char engineIdle(SWUARTengine *eng){
+#if PORTIO && STAGEDTX
+    for(unsigned char p=0;p<eng->portNum;p++){
+        if(eng->portOutMask[p]) return 0; //if staged outputs not written yet
+    }
+#endif
+#if TXWAVE
+    if(eng->waveMask && (eng->waveDMA || !eng->waveDry || eng->waveIn!=eng->waveDryIn)) return 0; //if rendered quanti not output yet (or output by the DMA)
+#endif
+#if PORTIO
+    //sampling all the ports with RX pins
+    for(unsigned char p=0;p<eng->portNum;p++){
+        if(eng->portRead[p]) eng->portIn[p]=readPort(eng->portID[p]);
+    }
+#endif
+
+    for(int w=0;w<eng->words;w++){
+        if(eng->TXkick[w]!=eng->TXkickAck[w]) return 0; //if UARTs kicked by API
+#if PACKETRX
+        if(eng->RXgap[w]) return 0; //if idle gaps being counted
+#endif
+#if STAGEDTX
+        if(eng->TXstage[w]) return 0; //if staged outputs not written yet
+#endif
+#if EDGERX
+        if(eng->RXwake[w]!=eng->RXwakeAck[w]) return 0; //if lines woken by START edge
+#endif
+#if BITSLICED
+        if(eng->TXbusy[w] || eng->TXpend[w] || eng->RXbusy[w]) return 0; //if frames being sent/received
+#else
+        if(eng->TXact[w]) return 0; //if frames being sent
+#endif
+
+        sliceword m=eng->RXen[w] & ~eng->RXsleep[w]; //enabled lines not sleeping
+        while(m){
+            int b=sliceCtz(m);
+            m&=m-1;
+            RXline *lptr=&eng->lineBuffer[w*SLICEBITS+b];
+#if BITSLICED
+            char oldVal=GETFLAG(eng->RXold[w],b);
+#else
+            if(lptr->RXbit!=0) return 0; //if frame being received
+            char oldVal=lptr->oldVal;
+#endif
+            if(samplePin(eng,lptr)!=oldVal) return 0; //if pin changed after the last sample
+        }
+    }
+
+    return 1;
+}
+
+unsigned long SWUARTengineSkip(SWUARTengine *eng, unsigned long ticks){
+    if(eng->initCalled == 0){ //if swuart not initialized
+        return 0;
+    }
+
+    disableInt();
+
+    if(eng->UARTnum!=0){ //(with no UARTs the isr does nothing)
+        if(!engineIdle(eng)){
+            ticks=0;
+        }else{ //advancing the quantum counters as ticks isr calls
+#if BITSLICED
+            eng->slicePhase=(unsigned char)((eng->slicePhase+ticks)%eng->bitQuanti);
+#else
+            unsigned short adv=(unsigned short)(ticks<<8); //(the phase of idle lines is only compared after START)
+            for(int w=0;w<eng->words;w++){
+                sliceword m=eng->RXen[w] & ~eng->RXsleep[w];
+                while(m){
+                    int b=sliceCtz(m);
+                    m&=m-1;
+                    eng->lineBuffer[w*SLICEBITS+b].RXphase+=adv;
+                }
+            }
+#endif
+#if TXWAVE
+            eng->waveOut+=(unsigned char)ticks; //(the ring is empty, its slots are read again only after render restarts it)
+#endif
+        }
+    }
+    eng->tickSeq+=(unsigned char)ticks; //counting the skipped calls
+#if TIMESTAMPS
+    eng->ticks+=ticks;
+#endif
+
+    enableInt();
+
+    return ticks;
+}
+
+#if STAGEDTX
+void SWUARTengineFlushTX(SWUARTengine *eng){
+    if(eng->initCalled == 0) return; //if swuart not initialized
+
+    disableInt();
+    writeOutputs(eng); //(the next isr call finds nothing staged)
+    enableInt();
+}
+#endif
+
+#if ISRPROF
+void SWUARTengineGetProfile(SWUARTengine *eng, SWUARTprof *prof){
+    disableInt();
+    *prof=eng->prof;
+    enableInt();
+}
+
+void SWUARTengineResetProfile(SWUARTengine *eng){
+    disableInt();
+    eng->prof.calls=0;
+    eng->prof.last=0;
+    eng->prof.min=0;
+    eng->prof.max=0;
+    eng->prof.total=0;
+    eng->prof.RXtotal=0;
+    for(int b=0;b<PROFBINS;b++) eng->prof.hist[b]=0;
+    enableInt();
+}
+#endif
+
+// ---------- PUBLIC FUNCTIONS ----------
+//(the functions of SWUART.h work on the default engine)
+
+int SWUARTgetHandle(char UARTname){
+    return SWUARTengineGetHandle(&defEngine,UARTname);
+}
+
+void SWUARTinit(){
+    if(defEngine.initCalled == 1){ //if already init, return 1
+        return;
+    }
+
+    SWUARTengineInit(&defEngine,MAXUARTS,RXBUFFLEN,TXBUFFLEN,BITQUANTI,SMPQUANTUM,
+            defUARTs,defTXstate,defLines,defRXstore,defTXstore,defMasks,defSync);
+    defEngine.edge=EDGERX; //only the default engine uses the edge functions
+#if TICKLESS
+    defEngine.tickless=1; //and programs the timer
+#endif
+#if TIMESTAMPS
+    SWUARTengineSetStamps(&defEngine,defRXstamps,defTXstamps);
+#endif
+
+    setupTimer(); //setup timer (and relative ISR)
+    startTimer(); //starting timer
+
+    return;
+
+}
+
+int SWUARTadd(int TXpin,int RXpin, char UARTname){
+    int retVal=SWUARTaddH(TXpin,RXpin,UARTname);
+    if(retVal>=0) return 0; //if created (handle returned)
+    return -retVal;
+}
+
+int SWUARTaddH(int TXpin,int RXpin, char UARTname){
+    return SWUARTengineAddH(&defEngine,TXpin,RXpin,UARTname);
+}
+
+int SWUARTsend(char msg, char UARTname, char clearRX, char blank){
+    return SWUARTsendWordH((unsigned char)msg,getHandle(&defEngine,UARTname),clearRX,blank);
+}
+
+int SWUARTsendH(char msg, int handle, char clearRX, char blank){
+    return SWUARTsendWordH((unsigned char)msg,handle,clearRX,blank);
+}
+
+int SWUARTsendWord(unsigned short msg, char UARTname, char clearRX, char blank){
+    return SWUARTsendWordH(msg,getHandle(&defEngine,UARTname),clearRX,blank);
+}
+
+int SWUARTsendWordH(unsigned short msg, int handle, char clearRX, char blank){
+    return SWUARTengineSendWordH(&defEngine,msg,handle,clearRX,blank);
+}
+
+int SWUARTreceive(char *msg, char UARTname){
+    return SWUARTreceiveH(msg,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTreceiveH(char *msg, int handle){
+    unsigned short data;
+    int retVal=SWUARTreceiveWordH(&data,handle);
+    if(retVal!=EMPTYBUFF && retVal!=NOINIT && retVal!=NAMEERR) *msg=(char)data; //if message read
+    return retVal;
+}
+
+int SWUARTreceiveWord(unsigned short *msg, char UARTname){
+    return SWUARTreceiveWordH(msg,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTreceiveWordH(unsigned short *msg, int handle){
+    return SWUARTengineReceiveWordH(&defEngine,msg,handle);
+}
+
+int SWUARTsendBuffer(const char *msgs, int len, char UARTname){
+    return SWUARTsendBufferH(msgs,len,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTsendBufferH(const char *msgs, int len, int handle){
+    return SWUARTengineSendBufferH(&defEngine,msgs,len,handle);
+}
+
+int SWUARTreceiveBuffer(char *msgs, int len, char UARTname, char *status){
+    return SWUARTreceiveBufferH(msgs,len,getHandle(&defEngine,UARTname),status);
+}
+
+int SWUARTreceiveBufferH(char *msgs, int len, int handle, char *status){
+    return SWUARTengineReceiveBufferH(&defEngine,msgs,len,handle,status);
+}
+
+int SWUARTreceive_blocking(char *msg, char UARTname){
+    return SWUARTreceiveTimeoutH(msg,getHandle(&defEngine,UARTname),FOREVER);
+}
+
+int SWUARTreceiveTimeout(char *msg, char UARTname, unsigned long timeout){
+    return SWUARTreceiveTimeoutH(msg,getHandle(&defEngine,UARTname),timeout);
+}
+
+int SWUARTreceiveTimeoutH(char *msg, int handle, unsigned long timeout){
+    unsigned short data;
+    int retVal=SWUARTengineReceiveWordTimeoutH(&defEngine,&data,handle,timeout);
+    if(retVal==0 || retVal==PARERR || retVal==STOPERR) *msg=(char)data; //if message read
+    return retVal;
+}
+
+int SWUARTsendTimeout(char msg, char UARTname, char clearRX, char blank, unsigned long timeout){
+    return SWUARTsendTimeoutH(msg,getHandle(&defEngine,UARTname),clearRX,blank,timeout);
+}
+
+int SWUARTsendTimeoutH(char msg, int handle, char clearRX, char blank, unsigned long timeout){
+    return SWUARTengineSendWordTimeoutH(&defEngine,(unsigned char)msg,handle,clearRX,blank,timeout);
+}
+
+int SWUARTclearBuffer(char TXn_RX, char UARTname){
+    return SWUARTclearBufferH(TXn_RX,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTclearBufferH(char TXn_RX, int handle){
+    return SWUARTengineClearBufferH(&defEngine,TXn_RX,handle);
+}
+
+int SWUARTsetBaud(unsigned short bitLen, char UARTname){
+    return SWUARTsetBaudH(bitLen,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTsetBaudH(unsigned short bitLen, int handle){
+    return SWUARTengineSetBaudH(&defEngine,bitLen,handle);
+}
+
+int SWUARTsetFormat(char format, char UARTname){
+    return SWUARTsetFormatH(format,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTsetFormatH(char format, int handle){
+    return SWUARTengineSetFormatH(&defEngine,format,handle);
+}
+
+#if UARTSTATS
+int SWUARTgetStats(SWUARTstats *stats, char UARTname, char reset){
+    return SWUARTgetStatsH(stats,getHandle(&defEngine,UARTname),reset);
+}
+
+int SWUARTgetStatsH(SWUARTstats *stats, int handle, char reset){
+    return SWUARTengineGetStatsH(&defEngine,stats,handle,reset);
+}
+#endif
+
+#if PACKETRX
+int SWUARTsetPacket(int delim, unsigned short gap, char UARTname){
+    return SWUARTsetPacketH(delim,gap,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTsetPacketH(int delim, unsigned short gap, int handle){
+    return SWUARTengineSetPacketH(&defEngine,delim,gap,handle);
+}
+
+int SWUARTreceivePacket(char *msgs, int len, char UARTname, char *status){
+    return SWUARTreceivePacketH(msgs,len,getHandle(&defEngine,UARTname),status);
+}
+
+int SWUARTreceivePacketH(char *msgs, int len, int handle, char *status){
+    return SWUARTengineReceivePacketH(&defEngine,msgs,len,handle,status);
+}
+#endif
+
+#if TIMESTAMPS
+swtick SWUARTgetTicks(){
+    return SWUARTengineGetTicks(&defEngine);
+}
+
+int SWUARTreceiveStamped(char *msg, swtick *stamp, char UARTname){
+    return SWUARTreceiveStampedH(msg,stamp,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTreceiveStampedH(char *msg, swtick *stamp, int handle){
+    unsigned short data;
+    int retVal=SWUARTreceiveWordStampedH(&data,stamp,handle);
+    if(retVal==0 || retVal==PARERR || retVal==STOPERR) *msg=(char)data; //if message read
+    return retVal;
+}
+
+int SWUARTreceiveWordStampedH(unsigned short *msg, swtick *stamp, int handle){
+    return SWUARTengineReceiveWordStampedH(&defEngine,msg,stamp,handle);
+}
+
+int SWUARTgetTXStamps(swtick *enqueued, swtick *started, char UARTname){
+    return SWUARTgetTXStampsH(enqueued,started,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTgetTXStampsH(swtick *enqueued, swtick *started, int handle){
+    return SWUARTengineGetTXStampsH(&defEngine,enqueued,started,handle);
+}
+#endif
+
+#if UARTEVENTS
+int SWUARTsetCallback(SWUARTcallback callback, char events, char mode, char UARTname){
+    return SWUARTsetCallbackH(callback,events,mode,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTsetCallbackH(SWUARTcallback callback, char events, char mode, int handle){
+    return SWUARTengineSetCallbackH(&defEngine,callback,events,mode,handle);
+}
+
+int SWUARTdispatch(){
+    return SWUARTengineDispatch(&defEngine);
+}
+#endif
+
+#if TXWAVE
+int SWUARTsetWave(char on, char UARTname){
+    return SWUARTsetWaveH(on,getHandle(&defEngine,UARTname));
+}
+
+int SWUARTsetWaveH(char on, int handle){
+    return SWUARTengineSetWaveH(&defEngine,on,handle);
+}
+
+int SWUARTrender(){
+    return SWUARTengineRender(&defEngine);
+}
+
+unsigned char SWUARTgetWaveUnderruns(){
+    return SWUARTengineGetWaveUnderruns(&defEngine);
+}
+#endif
+
+void SWUART_edge(int id){
+#if EDGERX
+    defEngine.RXwake[id/SLICEBITS]^=SLICEBIT(id); //waking line of the default engine
+#if TICKLESS
+    defEngine.tickStep=wakeTick(); //sampling it from the next quantum
+#endif
+#else
+    (void)id; //edge functions not used
+#endif
+}
+
+void SWUART_isr(){
+    SWUARTengine_isr(&defEngine);
+}
+
+unsigned long SWUARTskip(unsigned long ticks){
+    return SWUARTengineSkip(&defEngine,ticks);
+}
+
+#if ISRPROF
+void SWUARTgetProfile(SWUARTprof *prof){
+    SWUARTengineGetProfile(&defEngine,prof);
+}
+
+void SWUARTresetProfile(){
+    SWUARTengineResetProfile(&defEngine);
+}
+#endif
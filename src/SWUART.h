@@ -16,10 +16,62 @@
  * baud rate is then defined by the user, which has to call the SWUART_isr() function on a regular
  * basis inside an ISR, each call to the isr corresponds to a quantum and so the SWUART baud is 
  * defined by baud=1/(isr_frequency * BITQUANTI)
+ * Each UART can also be given its own bit length (also with a non integer number of quanti per bit)
+ * with SWUARTsetBaud(), so a single timer can serve UARTs with different baud rates
  * 
  *
  * The SWUART is platform independent, and the user must only implement the functions of SWUART_drivers.h
  * to port it to another platform, this also allows testing using a simulated environment on a laptop
+ *
+ * If the platform also implements the optional port functions of SWUART_drivers.h (and PORTIO is set),
+ * SWUART_isr() will read every used port only once at its beginning and write every used port only once
+ * at its end, so the GPIO access cost will depend on the number of ports instead of the number of UARTs
+ *
+ * If STAGEDTX is set, the TX levels computed by a SWUART_isr() call are staged and written at the beginning
+ * of the next call, before sampling the RX pins, so every output edge is written at a fixed time from the
+ * timer interrupt whatever the number of UARTs and the RX work (the TX waveforms are delayed by one quantum)
+ *
+ * Setting BITSLICED selects the bit-sliced engine: the state of the UARTs is stored bit-sliced across
+ * SLICEBITS wide words (one bit per UART) and sampling, start detection, bit counting and data shifting
+ * are done for a whole word of UARTs with a few bitwise operations, so the ISR cost grows with the
+ * number of words (MAXUARTS/SLICEBITS) instead of the number of UARTs. Only the GPIO access, the frame
+ * completion and the frame start are still done per UART. The received/transmitted data is the same
+ * of the per-UART engine, which is better suited for a small number of UARTs
+ *
+ * If the platform implements the optional edge functions of SWUART_drivers.h (and EDGERX is set),
+ * idle RX lines are not sampled: they arm a falling edge interrupt and sleep until the START bit
+ * edge wakes them, then they are sampled every quantum for one frame and go back to sleep, so the
+ * cost of quiet lines inside SWUART_isr() is close to zero
+ *
+ * If ISRPROF is set, every SWUART_isr() call is timed with the readCycles() counter of SWUART_drivers.h
+ * and its duration is recorded (last, min, max, log2 histogram and RX/TX share), see SWUARTgetProfile()
+ *
+ * If UARTSTATS is set, the ISR counts for each UART the sent and received frames, the frame errors, the
+ * frames lost with the RX buffer full and the false START bits, see SWUARTgetStats()
+ *
+ * If UARTEVENTS is set, each UART can have a callback called when a message is received, when its TX
+ * buffer is drained or on a RX error, directly inside the ISR or later by SWUARTdispatch() from the
+ * main loop, see SWUARTsetCallback()
+ *
+ * If TIMESTAMPS is set, SWUART_isr() advances a free-running quantum counter, each received message is
+ * stamped with the quantum of its START detection and each sent one with the quanti of its enqueue and of
+ * its START bit, see SWUARTreceiveStamped() and SWUARTgetTXStamps()
+ *
+ * If PACKETRX is set, each UART can group the received messages into packets ended by a delimiter
+ * and/or by an idle gap counted by the ISR after the STOP bit, see SWUARTsetPacket()
+ *
+ * If TXWAVE is set, the TX of some UARTs can be rendered from the main loop into a ring of port words
+ * (one for each quantum) and SWUART_isr() or a DMA of the platform only outputs one word per quantum,
+ * see SWUARTsetWave()
+ *
+ * If the platform implements the optional tick functions of SWUART_drivers.h (and TICKLESS is set), the
+ * default engine asks for its next SWUART_isr() call only at the next quantum with some work (a TX bit
+ * change, at most MAXTICKSTEP quanti later), so the ISR rate follows the TX traffic. It goes back to one
+ * call per quantum while any RX line is awake, so idle lines must sleep with EDGERX to get the savings
+ * (TX only UARTs, added with RXpin NORXPIN, have no RX line)
+ *
+ * The functions below work on a default engine sized by the config macros, more engines with their
+ * own sizes, bit timing and ISR can be created with SWUART_engine.h (SWUARTgroup<...> from C++)
  */
 
 #include "myList.h"
@@ -27,12 +79,42 @@
 
 // -------------------- CONFIG MACROS --------------------
 #define MAXUARTS 5 //maximum number of software UARTS
+#define MAXPIN 255 //highest pin number used by the UARTs (pins up to 255 are stored in a byte)
 #define RXBUFFLEN 10 //maximum number of messages on each RX buffer
 #define TXBUFFLEN 10  //maximum number of messages on each TX buffer
 
 #define BITQUANTI 5 //number of quanti on a UART bit
 #define SMPQUANTUM 2 //quantum in wich sample is taken (must be < BITQUANTI)
 
+#define PORTIO 0 //set to 1 if SWUART_drivers implements the optional port functions (getPinPort()/readPort()/writePort())
+#define MAXPORTS 4 //maximum number of GPIO ports accessed with the port functions (pins on other ports will use readPin()/writePin())
+
+#define STAGEDTX 0 //set to 1 to write the TX levels at the beginning of the next SWUART_isr() call (fixed output timing)
+
+#define BITSLICED 0 //set to 1 to use the bit-sliced engine instead of the per-UART one
+#define SLICEBITS 32 //number of UARTs processed by each word of the bit-sliced engine (32 or 64)
+
+#define EDGERX 0 //set to 1 if SWUART_drivers implements the optional edge functions (armEdge()/SWUART_edge() call)
+
+#define WAITTICK 0 //set to 1 if SWUART_drivers implements the optional waitTick() function (the blocking functions idle the CPU)
+
+#define ISRPROF 0 //set to 1 to profile SWUART_isr() (SWUART_drivers must implement the optional readCycles() function)
+
+#define UARTSTATS 0 //set to 1 to keep the statistics counters of each UART (SWUARTgetStats())
+
+#define UARTEVENTS 0 //set to 1 to allow the event callbacks of each UART (SWUARTsetCallback())
+#define EVQUEUELEN 8 //number of UARTs with deferred events queued for SWUARTdispatch() (1:254, more are found by a scan)
+
+#define PACKETRX 0 //set to 1 to allow the packet mode of each UART (SWUARTsetPacket())
+
+#define TIMESTAMPS 0 //set to 1 to stamp the RX/TX messages with the quantum counter (SWUARTreceiveStamped())
+
+#define TXWAVE 0 //set to 1 to allow the pre-rendered TX waveform mode of the UARTs (SWUARTsetWave(), needs PORTIO)
+#define WAVELEN 64 //number of quanti of the TX waveform ring (power of 2, 2:128)
+
+#define TICKLESS 0 //set to 1 if SWUART_drivers implements the optional tick functions (the ISR is only called when needed)
+#define MAXTICKSTEP 64 //longest period between two ISR calls in quanti with TICKLESS (1:255)
+
 // --------------------ERROR CODES --------------------
 #define NOINIT 1 //SWUART not initialized
 #define NAMEERR 2 //UART name invalid (eg. already in use/doesn't exist)
@@ -41,8 +123,33 @@
 #define EMPTYBUFF 5 //buffer is empty
 #define PARERR 6 //parity bit wrong
 #define STOPERR 7 //stop violation
+#define BAUDERR 8 //bit length not supported
+#define FORMATERR 9 //frame format not supported
+#define PINERR 10 //pin number out of 0:MAXPIN
+#define TIMEOUT 11 //timeout expired
+
+// -------------------- BIT LENGTH --------------------
+//bit lengths are expressed in quanti per bit as 8.8 fixed point numbers
+#define DEFBITLEN (BITQUANTI<<8) //default bit length
+#define MINBITLEN (2<<8) //minimum bit length
+#define MAXBITLEN 0xFF00 //maximum bit length
+//macro to compute the bit length of a baud rate given the SWUART_isr() call frequency (both in Hz)
+#define BITLEN(isrfreq,baud) ((unsigned short)(((unsigned long)(isrfreq)*256UL+(baud)/2)/(baud)))
+
+// -------------------- FRAME FORMAT --------------------
+#define PARNONE 0 //no parity bit
+#define PAREVEN 1 //even parity
+#define PARODD 2 //odd parity
+//macro to build a frame format from the number of data bits (5:9), the parity and the number of stop bits (1:2)
+#define FORMAT(bits,par,stop) ((char)(((bits)-5) | ((par)<<3) | (((stop)-1)<<5)))
+#define DEFFORMAT FORMAT(8,PAREVEN,1) //default frame format (8E1)
 
 // -------------------- FUNCTIONS --------------------
+/* The TX/RX buffers are lock-free single producer/single consumer rings shared with SWUART_isr(),
+ * so SWUARTsend(), SWUARTreceive() and SWUARTclearBuffer() never disable interrupts (except the send
+ * functions with TICKLESS, for the few instructions calling wakeTick()), they must only be called from
+ * a single context (e.g. the main loop, not from other ISRs)
+ */
 
 /* Initialize software UART, must be called one time at the
  * beginning of program
@@ -56,6 +163,12 @@ void SWUARTinit();
  * as RXpin of the same/another one, but this will cause a call to setPinMode() on the same pin
  * to set it as both input and output and also call writePin()/readPin() on that same pin, so this
  * must be taken into account while creating SWUART_drivers.c
+ * UARTs sharing the same RXpin also share the same RX decoder, so the pin is sampled and decoded
+ * only once and each received message is delivered to the RX buffers of all of them (each UART
+ * still has its own RX buffer, so clear/full conditions are independent)
+ *
+ * With RXpin NORXPIN the UART is TX only: it has no RX line, so the ISR never samples it (with TICKLESS
+ * the calls can skip to the next TX bit change) and its RX buffer stays empty
  *
  * UARTname is an 8 bit namecode for the UART
  *
@@ -65,7 +178,9 @@ void SWUARTinit();
  * NAMEERR - UART NOT created, UARTname already used
  * TXUSED - UART NOT created, TXpin already used
  * FULLBUFF - UART NOT created, maximum number reached
+ * PINERR - UART NOT created, TXpin out of 0:MAXPIN or RXpin out of 0:MAXPIN and not NORXPIN
  */
+#define NORXPIN -1 //RXpin of a TX only UART
 int SWUARTadd(int TXpin,int RXpin, char UARTname);
 
 /* Send the msg message with the UART UARTname
@@ -97,6 +212,7 @@ int SWUARTsend(char msg, char UARTname, char clearRX, char blank);
 int SWUARTreceive(char *msg, char UARTname);
 
 /* Try to read a message into msg from UART UARTname buffer (blocking)
+ * Same of SWUARTreceiveTimeout() with timeout FOREVER
  *
  * return:
  * 0 - message correctly read
@@ -107,6 +223,53 @@ int SWUARTreceive(char *msg, char UARTname);
  */
 int SWUARTreceive_blocking(char *msg, char UARTname);
 
+#define FOREVER 0xFFFFFFFFUL //timeout of the blocking functions waiting forever
+
+/* Read a message into msg from UART UARTname buffer, waiting up to timeout quanti (SWUART_isr() calls)
+ * for it if the buffer is empty (timeout 0 doesn't wait, FOREVER waits forever)
+ * The buffer is checked again only after each SWUART_isr() call (the only one adding messages), in between
+ * the CPU is idled with waitTick() if WAITTICK is set, otherwise a counter written by SWUART_isr() is polled
+ * (without disabling interrupts). Must not be called with interrupts disabled or from an ISR
+ *
+ * return:
+ * 0, NOINIT, PARERR, STOPERR, NAMEERR - same of SWUARTreceive()
+ * TIMEOUT - message NOT read, no messages for UARTname inside buffer after timeout quanti
+ */
+int SWUARTreceiveTimeout(char *msg, char UARTname, unsigned long timeout);
+
+/* Send the msg message with the UART UARTname, waiting up to timeout quanti (SWUART_isr() calls) for
+ * a free slot if the TX buffer is full (timeout 0 doesn't wait, FOREVER waits forever)
+ * The wait is the same of SWUARTreceiveTimeout()
+ *
+ * return:
+ * 0, NOINIT, NAMEERR - same of SWUARTsend()
+ * TIMEOUT - message NOT sent, TX buffer still full after timeout quanti
+ */
+int SWUARTsendTimeout(char msg, char UARTname, char clearRX, char blank, unsigned long timeout);
+
+/* Send up to len messages from the msgs array with the UART UARTname
+ * This is the same of calling SWUARTsend() for each message (with clearRX and
+ * blank not set), but the UART is searched only once and the messages are
+ * attached to the TX buffer all together
+ *
+ * return:
+ * >=0 - number of messages sent (less than len if the TX buffer became full)
+ * -NOINIT - no message sent, SWUART not initialized
+ * -NAMEERR - no message sent, UARTname doesn't exist
+ */
+int SWUARTsendBuffer(const char *msgs, int len, char UARTname);
+
+/* Try to read up to len messages into the msgs array from UART UARTname buffer (NON blocking)
+ * If status is not NULL, status[i] will be set to the result of the i-th message read:
+ * 0 (correctly read), PARERR (parity bit wrong) or STOPERR (STOP bit violated)
+ *
+ * return:
+ * >=0 - number of messages read (0 if no messages for UARTname inside buffer)
+ * -NOINIT - no message read, SWUART not initialized
+ * -NAMEERR - no message read, UARTname doesn't exist
+ */
+int SWUARTreceiveBuffer(char *msgs, int len, char UARTname, char *status);
+
 /* Clear the TX/RX buffer of UART UARTname
  * TXn_RX is a flag to indicate wich buffer to clear (0=TX , 1=RX)
  * If a message is currently being TX, the transmission will be completed anyway
@@ -118,6 +281,302 @@ int SWUARTreceive_blocking(char *msg, char UARTname);
  */
 int SWUARTclearBuffer(char TXn_RX, char UARTname);
 
+/* Set the bit length of UART UARTname (quanti per bit, 8.8 fixed point, see BITLEN()), the bit
+ * timing of each UART is generated by a phase accumulator, so non integer bit lengths don't build up
+ * error along the frame. RX samples are taken at SMPQUANTUM/BITQUANTI of each bit. UARTs sharing the
+ * RX pin are decoded once for each different bit length. New UARTs use DEFBITLEN.
+ * A frame being sent/received while the bit length changes will be corrupted.
+ * The bit-sliced engine only supports DEFBITLEN
+ *
+ * return:
+ * 0 - success
+ * NOINIT - bit length not set, SWUART not initialized
+ * NAMEERR - bit length not set, UARTname doesn't exist
+ * BAUDERR - bit length not set, out of MINBITLEN:MAXBITLEN (or not DEFBITLEN for the bit-sliced engine)
+ */
+int SWUARTsetBaud(unsigned short bitLen, char UARTname);
+
+/* Set the frame format of UART UARTname (see FORMAT(), e.g. FORMAT(8,PARNONE,1) for 8N1), the
+ * TX/RX state machines only sequence the bits of the format. The receiver only checks the first STOP
+ * bit. UARTs sharing the RX pin are decoded once for each different format. New UARTs use DEFFORMAT.
+ * Messages already inside the TX buffer are sent with the format they were queued with, a frame being
+ * received while the format changes will be lost. With 9 data bits, SWUARTsendWord()/SWUARTreceiveWord()
+ * must be used to send/receive the 9th bit (the other functions send it as 0 and drop it)
+ *
+ * return:
+ * 0 - success
+ * NOINIT - format not set, SWUART not initialized
+ * NAMEERR - format not set, UARTname doesn't exist
+ * FORMATERR - format not set, not a valid format
+ */
+int SWUARTsetFormat(char format, char UARTname);
+
+/* Same of SWUARTsend() and SWUARTreceive(), but the message is an unsigned short (for frame formats
+ * with 9 data bits, the unused high bits of a sent message are ignored)
+ */
+int SWUARTsendWord(unsigned short msg, char UARTname, char clearRX, char blank);
+int SWUARTreceiveWord(unsigned short *msg, char UARTname);
+
+// -------------------- HANDLE FUNCTIONS --------------------
+/* Each UART can also be addressed by an handle (an integer >=0) instead of its name, the
+ * handle is returned by SWUARTaddH()/SWUARTgetHandle() and stays valid for the whole program.
+ * The functions with the H suffix behave exactly like the ones without it (same arguments and
+ * return values), but take the handle in place of UARTname (an invalid handle gives NAMEERR).
+ * The name based functions translate the name with a 256 entries table, so both addressing
+ * modes take constant time
+ */
+
+/* Same of SWUARTadd(), but returning the handle of the new UART
+ *
+ * return:
+ * >=0 - UART correctly created, handle of the UART
+ * -NOINIT, -NAMEERR, -TXUSED, -FULLBUFF, -PINERR - UART NOT created (see SWUARTadd())
+ */
+int SWUARTaddH(int TXpin,int RXpin, char UARTname);
+
+/* Get the handle of UART UARTname
+ *
+ * return:
+ * >=0 - handle of the UART
+ * -NOINIT - SWUART not initialized
+ * -NAMEERR - UARTname doesn't exist
+ */
+int SWUARTgetHandle(char UARTname);
+
+int SWUARTsendH(char msg, int handle, char clearRX, char blank);
+int SWUARTreceiveH(char *msg, int handle);
+int SWUARTsendBufferH(const char *msgs, int len, int handle);
+int SWUARTreceiveBufferH(char *msgs, int len, int handle, char *status);
+int SWUARTclearBufferH(char TXn_RX, int handle);
+int SWUARTsetBaudH(unsigned short bitLen, int handle);
+int SWUARTsetFormatH(char format, int handle);
+int SWUARTsendWordH(unsigned short msg, int handle, char clearRX, char blank);
+int SWUARTreceiveWordH(unsigned short *msg, int handle);
+int SWUARTsendTimeoutH(char msg, int handle, char clearRX, char blank, unsigned long timeout);
+int SWUARTreceiveTimeoutH(char *msg, int handle, unsigned long timeout);
+
+// -------------------- VIRTUAL TIME --------------------
+/* Advance the SWUART by ticks quanti without calling SWUART_isr(), if it is idle: no frame being sent or
+ * received, no message waiting inside the TX buffers and no RX pin changed after its last sample.
+ * The state is left exactly as after ticks calls of SWUART_isr() with the pins unchanged, so a simulation
+ * can jump over the idle stretches up to its next event (pin write or call of the API) and stay
+ * bit-identical to stepping every quantum (the skipped calls are not profiled)
+ *
+ * return:
+ * ticks - quanti skipped
+ * 0 - SWUART not idle (or not initialized), SWUART_isr() must be called
+ */
+unsigned long SWUARTskip(unsigned long ticks);
+
+#if UARTSTATS
+// -------------------- UART STATISTICS --------------------
+/* The counters are incremented by SWUART_isr() and saturate at 65535, the high-water marks are the highest
+ * number of messages seen inside the buffers. A message received by a RX line is counted by every UART
+ * attached to it (the ones enabled to receive), also a false START bit (a START not LOW at its sample)
+ */
+typedef struct SWUARTstats{
+  unsigned short TXframes; //sent frames (blank messages excluded)
+  unsigned short RXframes; //received frames (with errors and lost ones included)
+  unsigned short parErrors; //received frames with parity bit wrong
+  unsigned short stopErrors; //received frames with stop violation
+  unsigned short overruns; //received frames lost because the RX buffer was full
+  unsigned short falseStarts; //START bits not confirmed by the sample (glitches/noise)
+  unsigned char TXhigh; //TX buffer high-water mark
+  unsigned char RXhigh; //RX buffer high-water mark
+} SWUARTstats;
+
+/* Copy the statistics of UART UARTname into stats (the copy is taken with interrupts disabled,
+ * so it is consistent), if reset is set (1) the statistics are also reset
+ *
+ * return:
+ * 0 - success
+ * NOINIT - statistics not read, SWUART not initialized
+ * NAMEERR - statistics not read, UARTname doesn't exist
+ */
+int SWUARTgetStats(SWUARTstats *stats, char UARTname, char reset);
+int SWUARTgetStatsH(SWUARTstats *stats, int handle, char reset);
+#endif
+
+#if PACKETRX
+// -------------------- PACKET MODE --------------------
+/* In packet mode the ISR marks the end of each packet inside the RX buffer: the message equal to the
+ * delimiter (e.g. '\n', it is the last message of its packet) or the last message before gap idle quanti
+ * counted from the end of its STOP bit (e.g. 3.5 frames of Modbus RTU). A packet also ends when it fills
+ * the RX buffer (the following messages are lost until it is read), so RXBUFFLEN bounds the packet length.
+ * With UARTEVENTS set, EVRX is raised once for each packet instead of once for each message
+ */
+#define NODELIM -1 //no packet delimiter
+
+/* Set the packet mode of UART UARTname, delim is the delimiter (NODELIM if none) and gap the idle quanti
+ * ending a packet (0 if none), with NODELIM and 0 the packet mode is turned off
+ *
+ * return:
+ * 0 - success
+ * NOINIT - packet mode not set, SWUART not initialized
+ * NAMEERR - packet mode not set, UARTname doesn't exist
+ * FORMATERR - packet mode not set, delim out of NODELIM:511
+ */
+int SWUARTsetPacket(int delim, unsigned short gap, char UARTname);
+int SWUARTsetPacketH(int delim, unsigned short gap, int handle);
+
+/* Read the next complete packet of UART UARTname into msgs (up to len messages), the messages of an
+ * unfinished packet are left inside the RX buffer. If status is not NULL it is set to the worst error of the
+ * packet messages (STOPERR, then PARERR) or to FULLBUFF if the packet was cut (RX buffer full or more than
+ * len messages, the rest of the packet is dropped), 0 otherwise
+ *
+ * return:
+ * >=0 - number of messages read into msgs
+ * -NOINIT - packet NOT read, SWUART not initialized
+ * -NAMEERR - packet NOT read, UARTname doesn't exist
+ * -EMPTYBUFF - packet NOT read, no complete packet inside the RX buffer
+ */
+int SWUARTreceivePacket(char *msgs, int len, char UARTname, char *status);
+int SWUARTreceivePacketH(char *msgs, int len, int handle, char *status);
+#endif
+
+// -------------------- TIMESTAMPS --------------------
+//quantum counter value (SWUART_isr() calls since SWUARTinit(), the first call is quantum 1), it wraps
+//around so stamps must be compared by difference (e.g. ~11.9 hours at 100kHz with 32 bits)
+typedef unsigned long swtick;
+
+#if TIMESTAMPS
+/* Get the quantum counter (the quanti skipped by SWUARTskip() are counted)
+ */
+swtick SWUARTgetTicks();
+
+/* Same of SWUARTreceive() and SWUARTreceiveWordH(), but also copying into stamp the quantum of
+ * the START detection of the message (stamp is not written if no message is read)
+ */
+int SWUARTreceiveStamped(char *msg, swtick *stamp, char UARTname);
+int SWUARTreceiveStampedH(char *msg, swtick *stamp, int handle);
+int SWUARTreceiveWordStampedH(unsigned short *msg, swtick *stamp, int handle);
+
+/* Copy the stamps of the last message sent by UART UARTname (blank messages excluded): enqueued is the
+ * quantum counter at its SWUARTsend() call, started the quantum of its START bit, so started-enqueued is
+ * the time spent inside the TX buffer (both are 0 if no message has been sent yet)
+ *
+ * return:
+ * 0 - success
+ * NOINIT - stamps not read, SWUART not initialized
+ * NAMEERR - stamps not read, UARTname doesn't exist
+ */
+int SWUARTgetTXStamps(swtick *enqueued, swtick *started, char UARTname);
+int SWUARTgetTXStampsH(swtick *enqueued, swtick *started, int handle);
+#endif
+
+#if UARTEVENTS
+// -------------------- UART EVENTS --------------------
+/* A callback registered with SWUARTsetCallback() is called with the handle of the UART, the event and,
+ * for EVERROR, the error code (PARERR/STOPERR of a received frame, FULLBUFF for a frame lost with the RX
+ * buffer full), the message itself is still read with SWUARTreceive()
+ *
+ * Direct callbacks are called inside SWUART_isr(), they must be short and may only call the non blocking
+ * send/receive functions of the same UART (every quantum spent there delays all the other UARTs).
+ * Deferred callbacks are called by SWUARTdispatch() from the main loop: the ISR only marks the event
+ * on the UART and queues the UART (once until dispatched), so events of the same kind are merged
+ * (e.g. one EVRX for all the messages received since the last dispatch, EVERROR with the last error)
+ */
+#define EVRX 1 //message received (saved into the RX buffer, also with errors)
+#define EVTXDONE 2 //TX buffer drained (last message sent)
+#define EVERROR 4 //message received with errors or lost
+#define EVALL 7 //all the events
+
+#define EVDIRECT 0 //callback called inside SWUART_isr()
+#define EVDEFERRED 1 //callback called by SWUARTdispatch()
+
+//event callback
+typedef void (*SWUARTcallback)(int handle, char event, char code);
+
+/* Set the callback of UART UARTname for the events of the mask events (EVRX|EVTXDONE|EVERROR), to be called
+ * directly inside the ISR (mode EVDIRECT) or by SWUARTdispatch() (mode EVDEFERRED), a NULL callback or an empty
+ * mask removes it (the deferred events not yet dispatched are dropped)
+ *
+ * return:
+ * 0 - success
+ * NOINIT - callback not set, SWUART not initialized
+ * NAMEERR - callback not set, UARTname doesn't exist
+ */
+int SWUARTsetCallback(SWUARTcallback callback, char events, char mode, char UARTname);
+int SWUARTsetCallbackH(SWUARTcallback callback, char events, char mode, int handle);
+
+/* Call the deferred callbacks of the events raised since the last call, must be called from the main
+ * loop (a single context), its cost depends on the UARTs with pending events and not on their total
+ * number (unless more than EVQUEUELEN UARTs had events at the same time)
+ *
+ * return:
+ * number of callbacks called
+ */
+int SWUARTdispatch();
+#endif
+
+#if TXWAVE
+// -------------------- TX WAVEFORM MODE --------------------
+/* The TX of an UART in wave mode is not sequenced by SWUART_isr(): SWUARTrender() runs the same TX state
+ * machine from the main loop and renders the levels of all the wave UARTs (whose TX pins must be on the same
+ * port) into a ring of WAVELEN port words, one for each quantum, up to WAVELEN-1 quanti ahead. SWUART_isr()
+ * then outputs one word per quantum (at the time of the other TX pins), or, if the platform implements the
+ * optional startWaveDMA() of SWUART_drivers.h, a timer-triggered DMA outputs the ring and SWUART_isr() only
+ * keeps its position. RX is not affected, EVTXDONE is not raised and (TIMESTAMPS) the START quantum of a
+ * message is the one of its rendering. If the ring runs empty (SWUARTrender() not called in time) the pins
+ * hold their level, stretching the bits being sent: these quanti are counted, see SWUARTgetWaveUnderruns()
+ */
+
+/* Set (on=1) or remove (on=0) UART UARTname from the wave mode, to be called while its TX is idle
+ * (a frame being sent is cut and its line returns HIGH)
+ *
+ * return:
+ * 0 - success
+ * NOINIT - mode not set, SWUART not initialized
+ * NAMEERR - mode not set, UARTname doesn't exist
+ * PINERR - mode not set, the TX pin is not accessed through the port functions or not on the port of the other wave UARTs
+ */
+int SWUARTsetWave(char on, char UARTname);
+int SWUARTsetWaveH(char on, int handle);
+
+/* Render the TX messages of the wave UARTs into the waveform ring until it is full or they are all idle,
+ * must be called from the main loop (the same context of SWUARTsend()) at least every WAVELEN-1 quanti
+ * while they send
+ *
+ * return:
+ * >=0 - number of quanti rendered
+ * -NOINIT - nothing rendered, SWUART not initialized
+ */
+int SWUARTrender();
+
+/* Get the quanti output by SWUART_isr() with the ring empty while the wave UARTs had frames to render
+ * since the last call (the counter wraps after 255)
+ */
+unsigned char SWUARTgetWaveUnderruns();
+#endif
+
+#if ISRPROF
+// -------------------- ISR PROFILING --------------------
+/* Durations are in readCycles() units, the RX part of a call is the port sampling and the RX loop,
+ * the TX part is the TX loop and the port writing (with STAGEDTX the staged outputs are written at
+ * the beginning, inside the RX part). Calls with no UARTs created are not profiled
+ */
+#define PROFBINS 16 //number of bins of the duration histogram
+
+//ISR profile
+typedef struct SWUARTprof{
+  unsigned long calls; //number of profiled calls
+  unsigned long last; //duration of the last call
+  unsigned long min; //duration of the shortest call
+  unsigned long max; //duration of the longest call (worst case)
+  unsigned long long total; //sum of the durations of all the calls
+  unsigned long long RXtotal; //sum of the durations of the RX parts (total-RXtotal is the TX share)
+  unsigned long hist[PROFBINS]; //hist[i] is the number of calls lasting 2^i:2^(i+1)-1 (hist[0] also 0, last bin also longer)
+} SWUARTprof;
+
+/* Copy the ISR profile into prof (the copy is taken with interrupts disabled, so it is consistent)
+ */
+void SWUARTgetProfile(SWUARTprof *prof);
+
+/* Reset the ISR profile
+ */
+void SWUARTresetProfile();
+#endif
+
 /* ISR of the SWUART, this is the code that must be executed at each sampling quantum
  * Inside this function, all the operations to send/receive messages on all UARTs will be implemented
  * Must be set as the ISR of the timer within setupTimer() function of SWUART_drivers.c
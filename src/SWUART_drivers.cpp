@@ -1,8 +1,47 @@
 #include "SWUART_drivers.h"
+#include "SWUART.h" //for the config macros
 #include "Arduino.h"
 
 volatile int isrflag=0;
 
+#if TICKLESS
+/* the tickless timer is the 16 bit Timer1 (so it can't be used together with other libraries using it, e.g. Servo):
+ * it runs free in normal mode and SWUART_isr() programs its compare value, so the skipped quanti raise no interrupt
+ */
+#define QUANTUMCOUNTS 167 //timer counts of a quantum (prescaler 64, same period of the fixed rate Timer2)
+volatile unsigned int tickAt=0; //compare value of the last SWUART_isr() call
+volatile unsigned char tickDelta=1; //quanti between the last SWUART_isr() call and the next one
+
+ISR(TIMER1_COMPA_vect){
+  if(isrflag){
+    tickAt=OCR1A;
+    OCR1A=tickAt+QUANTUMCOUNTS; //fixed rate if not programmed by SWUART_isr()
+    tickDelta=1;
+    SWUART_isr();
+  }
+}
+
+void setupTimer(){
+  noInterrupts();
+  TCCR1A=0; //setting normal mode
+  TCCR1B=0;
+  TCNT1=0;
+  tickAt=0;
+  tickDelta=1;
+  OCR1A=QUANTUMCOUNTS; //setting compare value
+  TIMSK1=2; //enable output compare A interupt
+  isrflag=1; //enable ISR
+  interrupts();
+}
+
+void stopTimer(){
+    TCCR1B=0;
+}
+
+void startTimer(){
+    TCCR1B=3; //setting prescaler of 64
+}
+#else
 ISR(TIMER2_COMPA_vect){
   if(isrflag)
     SWUART_isr();
@@ -24,6 +63,7 @@ void stopTimer(){
 void startTimer(){
     TCCR2B=4; //setting prescaler of 64  
 }
+#endif
 
 void setPinMode(int pin,char mode){
   if(mode=='O')
@@ -47,3 +87,130 @@ void disableInt(){
 void enableInt(){
   interrupts();
 }
+
+
+#if PORTIO
+char getPinPort(int pin,unsigned char *port,unsigned char *bit){
+  uint8_t p=digitalPinToPort(pin);
+  if(p==NOT_A_PIN)
+    return 1;
+
+  uint8_t mask=digitalPinToBitMask(pin);
+  uint8_t b=0;
+  while(!(mask & 1)){ //converting mask to bit position
+    mask>>=1;
+    b++;
+  }
+
+  *port=p;
+  *bit=b;
+  return 0;
+}
+
+portword readPort(unsigned char port){
+  return *portInputRegister(port);
+}
+
+void writePort(unsigned char port,portword mask,portword val){
+  volatile uint8_t *out=portOutputRegister(port);
+  *out=(*out & ~mask) | (val & mask);
+}
+#endif
+
+
+#if EDGERX
+//the edge functions use the pin change interrupts (so they can't be used together with other
+//libraries defining the PCINT ISRs, like SoftwareSerial)
+#define EDGEGROUPS 3 //number of pin change interrupt groups
+
+volatile uint8_t *edgePCMSK[EDGEGROUPS]; //mask register of each group
+volatile uint8_t *edgeIn[EDGEGROUPS][8]; //input register of each armed pin
+uint8_t edgeMask[EDGEGROUPS][8]; //mask of each armed pin inside its input register
+int edgeId[EDGEGROUPS][8]; //id to be passed to SWUART_edge() by each armed pin
+
+//function to call SWUART_edge() for the armed pins of a group that are LOW (falling edge)
+static void edgeISR(uint8_t g){
+  volatile uint8_t *msk=edgePCMSK[g];
+  uint8_t armed=*msk;
+  for(uint8_t b=0;b<8;b++){
+    if((armed & (1<<b)) && !(*edgeIn[g][b] & edgeMask[g][b])){
+      *msk&=~(1<<b); //one-shot, disarming
+      SWUART_edge(edgeId[g][b]);
+    }
+  }
+}
+
+ISR(PCINT0_vect){
+  edgeISR(0);
+}
+
+ISR(PCINT1_vect){
+  edgeISR(1);
+}
+
+ISR(PCINT2_vect){
+  edgeISR(2);
+}
+
+char armEdge(int pin,int id){
+  volatile uint8_t *msk=digitalPinToPCMSK(pin);
+  if(msk==0)
+    return 1;
+
+  uint8_t g=digitalPinToPCICRbit(pin);
+  uint8_t b=digitalPinToPCMSKbit(pin);
+  if(g>=EDGEGROUPS)
+    return 1;
+
+  edgePCMSK[g]=msk;
+  edgeIn[g][b]=portInputRegister(digitalPinToPort(pin));
+  edgeMask[g][b]=digitalPinToBitMask(pin);
+  edgeId[g][b]=id;
+
+  *msk|=1<<b; //arming pin
+  *digitalPinToPCICR(pin)|=1<<g; //enabling group interrupt
+  return 0;
+}
+#endif
+
+#if TXWAVE
+char startWaveDMA(unsigned char port,portword mask,volatile portword *ring,int slots){
+  (void)port; (void)mask; (void)ring; (void)slots;
+  return 1; //no DMA on the AVR boards, SWUART_isr() writes the wave pins
+}
+#endif
+
+#if TICKLESS
+unsigned char setNextTick(unsigned char delta){
+  OCR1A=tickAt+(unsigned int)delta*QUANTUMCOUNTS; //(called from the timer ISR, at most 255 quanti fit in 16 bits)
+  tickDelta=delta;
+  return delta;
+}
+
+unsigned char wakeTick(){
+  unsigned int now=TCNT1;
+  unsigned int step=(unsigned int)(now-tickAt)/QUANTUMCOUNTS+1; //quanti from the last call to the next quantum
+  if((unsigned int)(tickAt+step*QUANTUMCOUNTS-now)<2)
+    step++; //too close to set the compare before the timer passes it
+  if(step<tickDelta){
+    OCR1A=tickAt+step*QUANTUMCOUNTS;
+    tickDelta=step;
+  }
+  return tickDelta;
+}
+#endif
+
+#if WAITTICK //(this driver implements it, set WAITTICK in SWUART.h to use it)
+#include <avr/sleep.h>
+
+void waitTick(){
+  set_sleep_mode(SLEEP_MODE_IDLE); //timers keep running
+  sleep_mode(); //woken by the next interrupt
+}
+#endif
+
+#if ISRPROF
+unsigned long readCycles(){
+  return micros()*(F_CPU/1000000UL); //cycles (with the 4us resolution of micros() on 16MHz boards)
+}
+#endif
@@ -42,5 +42,103 @@ void disableInt();
 //interrupt enable function
 void enableInt();
 
+// -------------------- OPTIONAL PORT FUNCTIONS --------------------
+/* The following functions are only used if PORTIO is set to 1 inside SWUART.h, they allow
+ * the SWUART to sample all the RX pins of a port with a single read at the beginning of
+ * SWUART_isr() and to update all the TX pins of a port with a single write at its end, instead
+ * of calling readPin()/writePin() once per UART.
+ * A port is identified by an 8 bit platform dependent id, inside the port word the bit n
+ * corresponds to the n-th pin of the port
+ */
+
+typedef unsigned long portword; //port word type (must be able to hold all the pins of a port)
+
+/* function to get the port and the bit position of a pin
+ *
+ * return:
+ * 0 - port and bit correctly set
+ * 1 - the pin can't be accessed as part of a port (readPin()/writePin() will be used for it)
+ */
+char getPinPort(int pin,unsigned char *port,unsigned char *bit);
+
+// function to read all the pins of a port
+// returns the port word (bit=0:LOW, bit=1:HIGH)
+portword readPort(unsigned char port);
+
+// function to write the pins of a port
+// only the pins whose bit is set in mask are written with the corresponding bit of val
+void writePort(unsigned char port,portword mask,portword val);
+
+// -------------------- OPTIONAL EDGE FUNCTIONS --------------------
+/* The following functions are only used if EDGERX is set to 1 inside SWUART.h, they allow
+ * idle RX lines to sleep until the falling edge of a START bit instead of being sampled every quantum.
+ * Edge interrupts are one-shot: after armEdge(), at the first falling edge of the pin the platform
+ * must disarm the interrupt and call SWUART_edge() with the id given to armEdge() (from its pin
+ * change/external interrupt ISR, SWUART_edge() calls must not interrupt each other)
+ */
+
+//extern declaration of the edge callback (defined into SWUART.c)
+extern void SWUART_edge(int id);
+
+/* function to arm the falling edge interrupt of a pin (arming an already armed pin only updates id)
+ *
+ * return:
+ * 0 - edge interrupt armed
+ * 1 - the pin can't generate edge interrupts (its RX line will be sampled every quantum)
+ */
+char armEdge(int pin,int id);
+
+// -------------------- OPTIONAL WAVE FUNCTION --------------------
+/* The following function is only used if TXWAVE is set to 1 inside SWUART.h, it allows the platform
+ * to output the TX waveform ring with a timer-triggered DMA (or GPIO sequencer) instead of SWUART_isr()
+ */
+
+/* function to start, update or stop (mask 0) the output of the TX waveform ring: at each timer event
+ * of the engine, before its ISR is called, the peripheral must write the pins of mask of port with the
+ * next slot of ring (slots words, circular), starting from slot 0 at the first event after the call.
+ * While the output is running, a new call only changes the mask and keeps the position
+ *
+ * return:
+ * 0 - output started/updated (SWUART_isr() doesn't write the wave pins)
+ * 1 - not available (SWUART_isr() writes the wave pins)
+ */
+char startWaveDMA(unsigned char port,portword mask,volatile portword *ring,int slots);
+
+// -------------------- OPTIONAL TICK FUNCTIONS --------------------
+/* The following functions are only used if TICKLESS is set to 1 inside SWUART.h, they allow the
+ * default engine to skip the SWUART_isr() calls of the quanti without work (the timer keeps counting
+ * quanti, SWUART_isr() is only called at some of them)
+ */
+
+/* function called at the end of each SWUART_isr() call to ask for the next call delta quanti later
+ * (1 is the fixed rate), a platform can program a shorter period (e.g. limited by the timer width)
+ *
+ * return: quanti from this call to the next one as programmed (1:delta)
+ */
+unsigned char setNextTick(unsigned char delta);
+
+/* function called by SWUART_edge() and by the send functions (with interrupts disabled) to bring the
+ * next SWUART_isr() call forward to the next quantum
+ *
+ * return: quanti from the previous SWUART_isr() call to the next one
+ */
+unsigned char wakeTick();
+
+// -------------------- OPTIONAL WAIT FUNCTION --------------------
+/* The following function is only used if WAITTICK is set to 1 inside SWUART.h, it is called by the
+ * blocking functions (e.g. SWUARTreceiveTimeout()) while they wait for the next SWUART_isr() call
+ */
+
+// function to idle the CPU until the next interrupt (e.g. sleep/WFI), it can also return earlier
+void waitTick();
+
+// -------------------- OPTIONAL PROFILING FUNCTIONS --------------------
+/* The following function is only used if ISRPROF is set to 1 inside SWUART.h, it is called at the
+ * beginning, in the middle and at the end of SWUART_isr() to measure its duration
+ */
+
+// function to read a free running cycle (or timestamp) counter
+// returns the counter value (it can wrap around, only differences are used)
+unsigned long readCycles();
 
 #endif
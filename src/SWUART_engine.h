@@ -0,0 +1,498 @@
+#ifndef SWUART_ENGINE
+#define SWUART_ENGINE
+/* SWUART engine instances
+ *
+ * All the state of the SWUART (UARTs, RX/TX rings, RX lines, names, ports and channel masks) is held
+ * by an engine, the functions of SWUART.h work on a default engine sized by the config macros of SWUART.h
+ * (MAXUARTS, RXBUFFLEN, TXBUFFLEN, BITQUANTI, SMPQUANTUM) and driven by the timer of SWUART_drivers.
+ *
+ * More engines can be created with different sizes and bit timings, each one with its own UARTs, names,
+ * handles and ISR, so e.g. a fast group of UARTs and a slow group can be served by two different timers
+ * (the user calls the isr of each engine from its own timer ISR, the default engine still uses
+ * setupTimer()/startTimer()). A pin must only be used by a single engine, and only the default engine
+ * uses the edge functions (EDGERX), the lines of the other engines are always sampled.
+ *
+ * From C++ an engine is declared with SWUARTgroup<...> (see below), that holds the engine together with its
+ * storage sized at compile time. From C the storage must be declared with the sizes given to SWUARTengineInit()
+ */
+
+#include "SWUART.h"
+#include <stdint.h>
+
+// -------------------- DATA STRUCTURES --------------------
+#if MAXUARTS<255
+typedef unsigned char slotidx; //type of the indexes of UARTbuffer/lineBuffer (limits the UARTs of every engine)
+#define MAXSLOTS 254 //maximum number of UARTs of an engine
+#else
+typedef unsigned short slotidx; //type of the indexes of UARTbuffer/lineBuffer (limits the UARTs of every engine)
+#define MAXSLOTS 65534 //maximum number of UARTs of an engine
+#endif
+#define MAXQUEUE 254 //maximum number of messages of an engine RX/TX buffer
+
+#if MAXPIN<256
+typedef unsigned char pinidx; //type of the stored pin numbers
+#else
+typedef int pinidx; //type of the stored pin numbers
+#endif
+
+//RX message ring element: data (bits 0:8) and flags (from RXMSGFLAGS, flag mapping defined inside SWUART.cpp)
+typedef unsigned short message;
+//TX message ring element: frame word (bits 0:13) and flags (from TXMSGFLAGS, flag and frame bit mapping defined inside SWUART.cpp)
+typedef unsigned short txmessage;
+#define RXMSGFLAGS 12 //position of the flags inside a RX ring element
+#define TXMSGFLAGS 14 //position of the flags inside a TX ring element
+
+//UART data structure (cold)
+//it contains UART configuration and the indexes of the RX/TX rings, the state
+//used by the ISR at every quantum is inside UARTtx (same index) and RXline
+//
+//the TX/RX buffers are single producer/single consumer rings (one slot always left empty)
+//placed at the UART index inside the engine RX/TX storage:
+//the API functions are the only producer of TX and consumer of RX, the ISR is the only
+//consumer of TX and producer of RX, so each index is only written by one side.
+//Clearing a buffer from the wrong side is only requested (req/seq counters) and
+//applied by the side that owns the ring index
+typedef struct UARTDS{
+  char UARTname; //name of the UART (char integer value)
+  pinidx TXpin; //TX pin
+  pinidx RXpin; //RX pin
+  char format; //frame format (see FORMAT() inside SWUART.h)
+
+  // ---------- TX ----------
+  volatile unsigned char TXhead; //TX ring write index (written by API)
+  volatile unsigned char TXtail; //TX ring read index (written by ISR)
+  volatile unsigned char TXclrIdx; //TX ring write index at last clear request (written by API)
+  volatile unsigned char TXclrReq; //TX clear requests counter (written by API)
+  volatile unsigned char TXclrAck; //TX clear requests applied (written by ISR)
+
+  // ---------- RX ----------
+  volatile unsigned char RXhead; //RX ring write index (written by ISR)
+  volatile unsigned char RXtail; //RX ring read index (written by API)
+  volatile unsigned char RXflushIdx; //RX ring write index at last flush request (written by ISR)
+  volatile unsigned char RXflushSeq; //RX flush requests counter (written by ISR)
+  volatile unsigned char RXflushAck; //RX flush requests applied (written by API)
+  volatile unsigned char RXclrReq; //requests to drop the currently RX message (written by API)
+  volatile unsigned char RXclrAck; //drop requests seen by the ISR (written by ISR)
+
+  char RXflags; //flags of the UART RX (flag mapping defined inside SWUART.cpp)
+
+  slotidx RXline; //index of the RX line of RXpin inside lineBuffer
+  slotidx nextOnLine; //UARTbuffer index+1 of the next UART attached to the same RX line (0 if last)
+
+#if UARTSTATS
+  SWUARTstats stats; //statistics counters (written by ISR, high-water mark of TX written by API)
+#endif
+
+#if PACKETRX
+  unsigned short pktDelim; //packet delimiter (NOPKTDELIM if none)
+  unsigned short pktGap; //idle quanti ending a packet (0 if none)
+  volatile char pktOpen; //flag set if the last message of the RX ring doesn't end a packet (written by ISR)
+#endif
+
+#if TIMESTAMPS
+  swtick TXenqueued; //enqueue quantum of the last message sent (written by ISR)
+  swtick TXstarted; //START quantum of the last message sent (written by ISR)
+#endif
+
+#if UARTEVENTS
+  SWUARTcallback callback; //event callback (NULL if none)
+  char evMask; //events with the callback called (see EVRX...)
+  char evMode; //EVDIRECT or EVDEFERRED
+  volatile char evPend; //deferred events (toggled by ISR, bits != evAck are pending events, written by ISR)
+  volatile char evAck; //deferred events dispatched (written by dispatch)
+  volatile char evCode; //error code of the last deferred EVERROR (written by ISR)
+#endif
+
+} UARTDS;
+
+//UART TX state (hot)
+//it contains the TX state machine of an UART, read by the ISR at every quantum of a busy UART
+typedef struct UARTtx{
+  unsigned short frame; //bits still to be sent of the currently TX message (frame word, 0 if IDLE)
+  unsigned short phase; //phase of currently TX bit (quanti*256, a bit is over when it reaches bitLen)
+  unsigned short bitLen; //bit length (quanti per bit, 8.8 fixed point)
+  char flags; //flags of the currently TX message
+  unsigned char port; //index of TX pin port inside port table (NOPORT if accessed with writePin())
+  portword mask; //TX pin mask inside its port
+} UARTtx;
+
+//RX line data structure (hot)
+//it contains the RX state machine of a physical RX pin, UARTs sharing the
+//same RXpin are attached to the same line, so each pin is sampled and decoded
+//only once and the received messages are delivered to all the attached UARTs
+typedef struct RXline{
+  unsigned short RXphase; //phase of currently RX bit (quanti*256, a bit is over when it reaches bitLen)
+  unsigned short bitLen; //bit length of the line (quanti per bit, 8.8 fixed point)
+  unsigned short smpPhase; //phase of the sample inside each bit
+  unsigned short RXframe; //currently RX frame (samples are shifted in from the first STOP bit position)
+
+  portword RXmask; //RX pin mask inside its port
+  unsigned char RXport; //index of RX pin port inside port table (NOPORT if accessed with readPin())
+  pinidx RXpin; //RX pin
+
+  char RXbit; //currently RX bit
+    /* RXbit values:
+     * 0 - IDLE
+     * 1 - START
+     * 2:RXlen - DATA BITS, PARITY, STOP
+     */
+  char RXlen; //number of bits sampled for each frame (START to first STOP)
+  char oldVal; //old value of the line (used to detect start falling edge)
+  char format; //frame format of the line (see FORMAT() inside SWUART.h)
+  char RXflags; //flags of the line (same mapping of UART RX flags)
+
+  slotidx firstUART; //UARTbuffer index+1 of the first UART attached to the line
+
+#if TIMESTAMPS
+  swtick RXstamp; //START quantum of the currently RX message
+#endif
+#if PACKETRX
+  unsigned short gapCnt; //idle quanti after the last message (counted while inside RXgap)
+#endif
+
+} RXline;
+
+// ---------- CHANNEL MASKS ----------
+//bit b of word w of each TX mask is the state of UART w*SLICEBITS+b of UARTbuffer,
+//bit b of word w of each RX mask is the state of line w*SLICEBITS+b of lineBuffer
+//(the ISR only visits the channels whose bit is set in the masks)
+#if SLICEBITS==64
+typedef uint64_t sliceword;
+#else
+typedef uint32_t sliceword;
+#endif
+#define SLICEWORDS(uarts) (((uarts)+SLICEBITS-1)/SLICEBITS) //number of words of each mask of an engine with uarts UARTs
+
+#define CNTPLANES 4 //number of bit planes of the bit-sliced bit counters (frame bits 1:14)
+#define SHPLANES 12 //number of bit planes of the bit-sliced shift registers (up to 9 data bits + parity + 2 stop)
+
+//number of masks of an engine with bitquanti quanti per bit (each mask is SLICEWORDS() words)
+#if BITSLICED
+#define SLICEMASKS(bitquanti) (9+PACKETRX+2*STAGEDTX+TXWAVE+2*((bitquanti)+2*CNTPLANES+SHPLANES))
+#else
+#define SLICEMASKS(bitquanti) (5+PACKETRX+2*STAGEDTX+TXWAVE)
+#endif
+#define SYNCMASKS 4 //number of masks shared with the API and the edge callback (each mask is SLICEWORDS() words)
+
+//engine data structure
+//it contains the state of an engine and the pointers to its storage
+typedef struct SWUARTengine{
+  // ---------- STORAGE ----------
+  volatile UARTDS *UARTbuffer; //UARTDS objects memory
+  UARTtx *TXstate; //UART TX states memory
+  RXline *lineBuffer; //RX lines (at most one for each UART)
+  message *RXstore; //RX rings memory (RXbuffLen+1 slots for each UART)
+  txmessage *TXstore; //TX rings memory (TXbuffLen+1 slots for each UART)
+  int maxUARTs; //number of UARTDS objects (and RX lines)
+  unsigned char RXbuffLen; //maximum number of messages on each RX buffer
+  unsigned char TXbuffLen; //maximum number of messages on each TX buffer
+
+  // ---------- BIT TIMING ----------
+  unsigned char bitQuanti; //number of quanti of the default bit length
+  unsigned char smpQuantum; //quantum in wich sample is taken (of bitQuanti)
+  unsigned short defBitLen; //default bit length (bitQuanti<<8)
+  char edge; //flag set if idle RX lines can sleep until the START edge (EDGERX)
+  volatile unsigned char tickSeq; //quanti counter (wrapping, written by ISR, waited on by the blocking functions)
+#if TICKLESS
+  char tickless; //flag set if the ISR programs its next call with the tick functions (TICKLESS)
+  volatile unsigned char tickStep; //quanti from the previous isr call to the next one (written by ISR and by SWUART_edge())
+#endif
+#if TIMESTAMPS
+  volatile swtick ticks; //quantum counter (written by ISR)
+  swtick *RXstamps; //RX stamp rings memory (RXbuffLen+1 slots for each UART, NULL if not set)
+  swtick *TXstamps; //TX stamp rings memory (TXbuffLen+1 slots for each UART, NULL if not set)
+#endif
+
+  // ---------- UARTS ----------
+  slotidx UARTnum; //number of created UARTs (UARTbuffer indexes 0:UARTnum-1)
+  char initCalled; //flag to set if init has been called
+
+  slotidx lineNum; //number of used RX lines
+  slotidx nameTable[256]; //UARTbuffer index+1 of the UART with each name (0 if name not used)
+
+#if PORTIO
+  // ---------- PORT TABLE ----------
+  unsigned char portID[MAXPORTS]; //platform id of each used port
+  char portRead[MAXPORTS]; //flag set if the port contains at least one RX pin
+  portword portIn[MAXPORTS]; //port values sampled at the beginning of the ISR
+  portword portOutMask[MAXPORTS]; //mask of the pins to be written at the end of the ISR
+  portword portOutVal[MAXPORTS]; //values of the pins to be written at the end of the ISR
+  unsigned char portNum; //number of used ports
+#endif
+
+  // ---------- CHANNEL MASKS ----------
+  int words; //number of words of each mask
+  sliceword *RXen; //RX enabled
+  sliceword *RXedge; //line can sleep until the START edge
+  sliceword *RXsleep; //line sleeping until START edge
+  volatile sliceword *RXwake; //line wakes (toggled by SWUART_edge(), written by edge ISR)
+  volatile sliceword *RXwakeAck; //line wakes seen by ISR (bits != RXwake are pending wakes, written by ISR)
+#if PACKETRX
+  sliceword *RXgap; //line counting the idle gap that ends the open packets of its UARTs
+#endif
+
+  sliceword *TXen; //TX enabled
+  volatile sliceword *TXkick; //TX ring kicks (toggled by API when TX ring not empty, written by API)
+  volatile sliceword *TXkickAck; //TX ring kicks seen by ISR (bits != TXkick are pending kicks, written by ISR)
+#if STAGEDTX
+  sliceword *TXstage; //TX pin (not accessed through the ports) with a level staged for the next call
+  sliceword *TXstageVal; //staged TX pin levels
+#endif
+#if TXWAVE
+  sliceword *TXwave; //TX rendered into the waveform ring (not sequenced by the ISR)
+#endif
+#if !BITSLICED
+  sliceword *TXact; //TX not idle or TX ring not empty
+#else
+  // ---------- BIT-SLICED ENGINE STATE ----------
+  //(the masks with more planes store plane i at word i*words)
+  sliceword *RXbusy; //RX not idle
+  sliceword *RXold; //old value of the line (used to detect start falling edge)
+  sliceword *RXslot; //[bitQuanti] RX phase slot (quantum of start detection modulo bitQuanti)
+  sliceword *RXcnt; //[CNTPLANES] currently RX bit (same values of RXbit)
+  sliceword *RXsh; //[SHPLANES] RX shift register (after STOP: data bits, parity, stop in the last planes)
+  sliceword *RXend; //[CNTPLANES] RX bit ending the frame (RXlen+1)
+
+  sliceword *TXbusy; //TX not idle
+  sliceword *TXpend; //TX ring not empty
+  sliceword *TXblank; //currently TX message is blank
+  sliceword *TXslot; //[bitQuanti] TX phase slot (quantum of START bit modulo bitQuanti)
+  sliceword *TXcnt; //[CNTPLANES] currently TX bit (same values of line RXbit)
+  sliceword *TXsh; //[SHPLANES] TX shift register (bits still to be sent after START)
+  sliceword *TXend; //[CNTPLANES] TX bit ending the frame (number of frame bits+1)
+
+  unsigned char slicePhase; //current quantum modulo bitQuanti
+#endif
+
+#if UARTEVENTS
+  // ---------- DEFERRED EVENTS ----------
+  //single producer (ISR)/single consumer (dispatch) ring of the UARTs with pending events
+  volatile slotidx evQueue[EVQUEUELEN+1]; //UARTbuffer indexes (EVQUEUELEN+1 slots)
+  volatile unsigned char evHead; //write index (written by ISR)
+  volatile unsigned char evTail; //read index (written by dispatch)
+  volatile char evOverflow; //flag set if an UART didn't fit into the ring (dispatch scans all the UARTs)
+#endif
+
+#if TXWAVE
+  // ---------- TX WAVEFORM RING ----------
+  //port words of the wave UARTs, slot i is output at the quanti i, i+WAVELEN... (counted from the ring start):
+  //the slots up to waveIn (excluded) are written by render, the ISR outputs slot waveOut and, if render
+  //didn't write it in time, writes it with the last word (so a DMA reading the ring always finds a valid word)
+  volatile portword waveBuf[WAVELEN]; //ring slots
+  volatile unsigned char waveIn; //index (modulo 256) of the next slot to render (written by render)
+  volatile unsigned char waveOut; //index (modulo 256) of the slot output at this quantum (written by ISR)
+  volatile char waveDry; //flag set if the ISR found the ring empty with waveIn equal to waveDryIn (written by ISR)
+  volatile unsigned char waveDryIn; //waveIn seen when the ring was found empty (written by ISR)
+  volatile char waveBusy; //flag set if the wave UARTs have frames still to render (written by render)
+  volatile unsigned char waveUnder; //quanti output with the ring empty while waveBusy (written by ISR)
+  unsigned char waveUnderAck; //underruns already read (written by API)
+  char waveDMA; //flag set if the ring is output by startWaveDMA()
+  unsigned char wavePort; //index of the port of the wave UARTs inside port table
+  portword waveMask; //TX pin mask of the wave UARTs inside their port
+  portword waveLast; //last word output (written by ISR)
+  portword waveWord; //last word rendered (written by render)
+#endif
+
+#if ISRPROF
+  SWUARTprof prof; //ISR profile
+#endif
+} SWUARTengine;
+
+// -------------------- FUNCTIONS --------------------
+/* Initialize the engine eng with its storage, must be called one time before any other
+ * function of the engine (SWUARTgroup calls it inside its constructor)
+ *
+ * arguments:
+ * maxUARTs - maximum number of UARTs (1:MAXSLOTS)
+ * RXbuffLen, TXbuffLen - maximum number of messages on each RX/TX buffer (1:MAXQUEUE)
+ * bitQuanti, smpQuantum - default bit length in quanti and quantum in wich sample is taken (< bitQuanti)
+ * UARTs, TXstate, lines - arrays of maxUARTs UARTDS, UARTtx and RXline
+ * RXstore, TXstore - arrays of maxUARTs*(RXbuffLen+1) message and maxUARTs*(TXbuffLen+1) txmessage
+ * masks - array of SLICEMASKS(bitQuanti)*SLICEWORDS(maxUARTs) sliceword
+ * sync - array of SYNCMASKS*SLICEWORDS(maxUARTs) sliceword
+ */
+void SWUARTengineInit(SWUARTengine *eng, int maxUARTs, unsigned char RXbuffLen, unsigned char TXbuffLen,
+        unsigned char bitQuanti, unsigned char smpQuantum, UARTDS *UARTs, UARTtx *TXstate, RXline *lines,
+        message *RXstore, txmessage *TXstore, sliceword *masks, volatile sliceword *sync);
+
+#if TIMESTAMPS
+/* Set the stamp rings of engine eng (after SWUARTengineInit(), SWUARTgroup calls it inside its constructor),
+ * without them the messages are not stamped
+ *
+ * arguments:
+ * RXstamps, TXstamps - arrays of maxUARTs*(RXbuffLen+1) and maxUARTs*(TXbuffLen+1) swtick
+ */
+void SWUARTengineSetStamps(SWUARTengine *eng, swtick *RXstamps, swtick *TXstamps);
+#endif
+
+/* Same of SWUARTengineAddH(), but the UART has no name and can only be addressed by the returned handle
+ * (e.g. engines with more than 255 UARTs), returns the handle or the negative error code
+ */
+int SWUARTengineAddUnnamedH(SWUARTengine *eng, int TXpin,int RXpin);
+
+/* Same of the handle functions of SWUART.h, but working on the UARTs of engine eng
+ * (handles and names are local to each engine)
+ */
+int SWUARTengineAddH(SWUARTengine *eng, int TXpin,int RXpin, char UARTname);
+int SWUARTengineGetHandle(SWUARTengine *eng, char UARTname);
+int SWUARTengineSendWordH(SWUARTengine *eng, unsigned short msg, int handle, char clearRX, char blank);
+int SWUARTengineReceiveWordH(SWUARTengine *eng, unsigned short *msg, int handle);
+int SWUARTengineSendBufferH(SWUARTengine *eng, const char *msgs, int len, int handle);
+int SWUARTengineReceiveBufferH(SWUARTengine *eng, char *msgs, int len, int handle, char *status);
+int SWUARTengineClearBufferH(SWUARTengine *eng, char TXn_RX, int handle);
+int SWUARTengineSetBaudH(SWUARTengine *eng, unsigned short bitLen, int handle);
+int SWUARTengineSetFormatH(SWUARTengine *eng, char format, int handle);
+int SWUARTengineSendWordTimeoutH(SWUARTengine *eng, unsigned short msg, int handle, char clearRX, char blank, unsigned long timeout);
+int SWUARTengineReceiveWordTimeoutH(SWUARTengine *eng, unsigned short *msg, int handle, unsigned long timeout);
+#if UARTSTATS
+int SWUARTengineGetStatsH(SWUARTengine *eng, SWUARTstats *stats, int handle, char reset);
+#endif
+#if PACKETRX
+int SWUARTengineSetPacketH(SWUARTengine *eng, int delim, unsigned short gap, int handle);
+int SWUARTengineReceivePacketH(SWUARTengine *eng, char *msgs, int len, int handle, char *status);
+#endif
+#if TIMESTAMPS
+swtick SWUARTengineGetTicks(SWUARTengine *eng);
+int SWUARTengineReceiveWordStampedH(SWUARTengine *eng, unsigned short *msg, swtick *stamp, int handle);
+int SWUARTengineGetTXStampsH(SWUARTengine *eng, swtick *enqueued, swtick *started, int handle);
+#endif
+#if UARTEVENTS
+int SWUARTengineSetCallbackH(SWUARTengine *eng, SWUARTcallback callback, char events, char mode, int handle);
+int SWUARTengineDispatch(SWUARTengine *eng); //same of SWUARTdispatch(), but for engine eng
+#endif
+#if TXWAVE
+int SWUARTengineSetWaveH(SWUARTengine *eng, char on, int handle);
+int SWUARTengineRender(SWUARTengine *eng); //same of SWUARTrender(), but for engine eng
+unsigned char SWUARTengineGetWaveUnderruns(SWUARTengine *eng); //same of SWUARTgetWaveUnderruns(), but for engine eng
+#endif
+
+/* ISR of engine eng, must be called at each sampling quantum of the engine
+ * (SWUART_isr() is the ISR of the default engine)
+ */
+void SWUARTengine_isr(SWUARTengine *eng);
+
+//same of SWUARTskip(), but for engine eng
+unsigned long SWUARTengineSkip(SWUARTengine *eng, unsigned long ticks);
+
+#if STAGEDTX
+/* Write at once the TX levels staged by the last isr call of engine eng (instead of at the beginning of the
+ * next call), only between two isr calls: e.g. a lock-step simulation exchanging the wires between the calls
+ * flushes them before the exchange, so the next call samples them as the written pins of a single engine
+ */
+void SWUARTengineFlushTX(SWUARTengine *eng);
+#endif
+
+#if ISRPROF
+//same of SWUARTgetProfile()/SWUARTresetProfile(), but for the ISR of engine eng
+void SWUARTengineGetProfile(SWUARTengine *eng, SWUARTprof *prof);
+void SWUARTengineResetProfile(SWUARTengine *eng);
+#endif
+
+#ifdef __cplusplus
+/* C++ engine with its storage, sized at compile time:
+ * UARTS - maximum number of UARTs
+ * RXLEN, TXLEN - maximum number of messages on each RX/TX buffer
+ * BITQ, SMPQ - default bit length in quanti and quantum in wich sample is taken
+ * RAMBUDGET - maximum size of the engine in bytes (0 if not checked), a bigger engine doesn't compile
+ *
+ * e.g. a fast and a slow group, each one on its own timer ISR:
+ *   SWUARTgroup<4,16,16> fast;
+ *   SWUARTgroup<8,4,4,8,4,1024> slow;
+ *   ISR(TIMER1_COMPA_vect){ fast.isr(); }
+ *   ISR(TIMER2_COMPA_vect){ slow.isr(); }
+ *
+ * The member functions are the same of the handle functions of SWUART.h (with the same return values)
+ */
+template<int UARTS, int RXLEN=RXBUFFLEN, int TXLEN=TXBUFFLEN, int BITQ=BITQUANTI, int SMPQ=SMPQUANTUM, unsigned long RAMBUDGET=0>
+class SWUARTgroup{
+public:
+  static constexpr int WORDS=SLICEWORDS(UARTS); //number of words of each mask
+
+  static_assert(UARTS>0 && UARTS<=MAXSLOTS, "UARTS out of 1:MAXSLOTS");
+  static_assert(RXLEN>0 && RXLEN<=MAXQUEUE && TXLEN>0 && TXLEN<=MAXQUEUE, "RXLEN/TXLEN out of 1:MAXQUEUE");
+  static_assert(BITQ>=2 && BITQ<=255 && SMPQ<BITQ, "BITQ must be 2:255 and SMPQ < BITQ");
+
+  SWUARTgroup(){
+    static_assert(RAMBUDGET==0 || sizeof(SWUARTgroup)<=RAMBUDGET, "SWUARTgroup exceeds its RAM budget");
+    SWUARTengineInit(&eng,UARTS,RXLEN,TXLEN,BITQ,SMPQ,UARTs,TXstate,lines,RXstore,TXstore,masks,sync);
+#if TIMESTAMPS
+    SWUARTengineSetStamps(&eng,RXstamps,TXstamps);
+#endif
+  }
+
+  int add(int TXpin, int RXpin, char UARTname){ return SWUARTengineAddH(&eng,TXpin,RXpin,UARTname); }
+  int addUnnamed(int TXpin, int RXpin){ return SWUARTengineAddUnnamedH(&eng,TXpin,RXpin); } //see SWUARTengineAddUnnamedH()
+  int getHandle(char UARTname){ return SWUARTengineGetHandle(&eng,UARTname); }
+  int send(char msg, int handle, char clearRX=0, char blank=0){ return SWUARTengineSendWordH(&eng,(unsigned char)msg,handle,clearRX,blank); }
+  int sendWord(unsigned short msg, int handle, char clearRX=0, char blank=0){ return SWUARTengineSendWordH(&eng,msg,handle,clearRX,blank); }
+  int receive(char *msg, int handle){
+    unsigned short data;
+    int retVal=SWUARTengineReceiveWordH(&eng,&data,handle);
+    if(retVal!=EMPTYBUFF && retVal!=NAMEERR) *msg=(char)data; //if message read
+    return retVal;
+  }
+  int receiveWord(unsigned short *msg, int handle){ return SWUARTengineReceiveWordH(&eng,msg,handle); }
+  int sendWordTimeout(unsigned short msg, int handle, unsigned long timeout, char clearRX=0, char blank=0){
+    return SWUARTengineSendWordTimeoutH(&eng,msg,handle,clearRX,blank,timeout);
+  }
+  int receiveWordTimeout(unsigned short *msg, int handle, unsigned long timeout){
+    return SWUARTengineReceiveWordTimeoutH(&eng,msg,handle,timeout);
+  }
+  int sendBuffer(const char *msgs, int len, int handle){ return SWUARTengineSendBufferH(&eng,msgs,len,handle); }
+  int receiveBuffer(char *msgs, int len, int handle, char *status=NULL){ return SWUARTengineReceiveBufferH(&eng,msgs,len,handle,status); }
+  int clearBuffer(char TXn_RX, int handle){ return SWUARTengineClearBufferH(&eng,TXn_RX,handle); }
+  int setBaud(unsigned short bitLen, int handle){ return SWUARTengineSetBaudH(&eng,bitLen,handle); }
+  int setFormat(char format, int handle){ return SWUARTengineSetFormatH(&eng,format,handle); }
+#if UARTSTATS
+  int getStats(SWUARTstats *stats, int handle, char reset=0){ return SWUARTengineGetStatsH(&eng,stats,handle,reset); }
+#endif
+#if PACKETRX
+  int setPacket(int delim, unsigned short gap, int handle){ return SWUARTengineSetPacketH(&eng,delim,gap,handle); }
+  int receivePacket(char *msgs, int len, int handle, char *status=NULL){ return SWUARTengineReceivePacketH(&eng,msgs,len,handle,status); }
+#endif
+#if TIMESTAMPS
+  swtick getTicks(){ return SWUARTengineGetTicks(&eng); }
+  int receiveWordStamped(unsigned short *msg, swtick *stamp, int handle){ return SWUARTengineReceiveWordStampedH(&eng,msg,stamp,handle); }
+  int getTXStamps(swtick *enqueued, swtick *started, int handle){ return SWUARTengineGetTXStampsH(&eng,enqueued,started,handle); }
+#endif
+#if UARTEVENTS
+  int setCallback(SWUARTcallback callback, char events, char mode, int handle){
+    return SWUARTengineSetCallbackH(&eng,callback,events,mode,handle);
+  }
+  int dispatch(){ return SWUARTengineDispatch(&eng); } //see SWUARTdispatch()
+#endif
+#if TXWAVE
+  int setWave(char on, int handle){ return SWUARTengineSetWaveH(&eng,on,handle); }
+  int render(){ return SWUARTengineRender(&eng); } //see SWUARTrender()
+  unsigned char getWaveUnderruns(){ return SWUARTengineGetWaveUnderruns(&eng); }
+#endif
+
+  void isr(){ SWUARTengine_isr(&eng); } //ISR of the engine, to be called at each quantum
+  unsigned long skip(unsigned long ticks){ return SWUARTengineSkip(&eng,ticks); } //see SWUARTskip()
+#if STAGEDTX
+  void flushTX(){ SWUARTengineFlushTX(&eng); } //see SWUARTengineFlushTX()
+#endif
+#if ISRPROF
+  void getProfile(SWUARTprof *prof){ SWUARTengineGetProfile(&eng,prof); }
+  void resetProfile(){ SWUARTengineResetProfile(&eng); }
+#endif
+
+  SWUARTengine *engine(){ return &eng; } //engine, for the SWUARTengine functions
+
+private:
+  SWUARTengine eng;
+  UARTDS UARTs[UARTS];
+  UARTtx TXstate[UARTS];
+  RXline lines[UARTS];
+  message RXstore[UARTS*(RXLEN+1)];
+  txmessage TXstore[UARTS*(TXLEN+1)];
+  sliceword masks[SLICEMASKS(BITQ)*WORDS];
+  volatile sliceword sync[SYNCMASKS*WORDS];
+#if TIMESTAMPS
+  swtick RXstamps[UARTS*(RXLEN+1)];
+  swtick TXstamps[UARTS*(TXLEN+1)];
+#endif
+};
+#endif
+
+#endif